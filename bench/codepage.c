@@ -0,0 +1,201 @@
+#include <termlike/graphics/codepage.h> // codepage, codepage_*, CODEPAGE_*
+
+#include <termlike/resources/cp437.h> // CP437, CP437_LENGTH
+
+#include <stdio.h> // printf
+#include <stdlib.h> // malloc, free, exit, EXIT_FAILURE
+#include <stdint.h> // uint8_t, uint16_t, uint32_t
+#include <stddef.h> // size_t
+
+#include <string.h> // memcmp
+#include <time.h> // clock, clock_t, CLOCKS_PER_SEC
+
+/**
+ * The number of characters looked up on each iteration.
+ */
+#define TEXT_LENGTH (4 * 1024)
+/**
+ * The number of times text is looked up per measurement.
+ */
+#define ITERATIONS 5000
+
+/**
+ * Represents a function that looks up the glyph index of each character.
+ */
+typedef void lookup_func(struct codepage const *,
+                         uint32_t const *, size_t, uint8_t *);
+
+static void lookup_scan(struct codepage const *,
+                        uint32_t const *, size_t, uint8_t *);
+static void lookup_table(struct codepage const *,
+                         uint32_t const *, size_t, uint8_t *);
+
+static uint8_t scan_index(uint32_t code);
+
+static void fill(uint32_t *, size_t length, size_t symbol_frequency);
+static double measure(lookup_func *, struct codepage const *,
+                      uint32_t const *, size_t, uint8_t *);
+
+int
+main(void)
+{
+    struct codepage * const codepage = codepage_init(CP437, CP437_LENGTH);
+
+    uint32_t * const text = malloc(sizeof(uint32_t) * TEXT_LENGTH);
+
+    uint8_t * const expected = malloc(sizeof(uint8_t) * TEXT_LENGTH);
+    uint8_t * const actual = malloc(sizeof(uint8_t) * TEXT_LENGTH);
+
+    // plain ASCII, then ASCII with increasingly frequent box-drawing, block
+    // and accented characters (e.g. "┌─┐", "▓▒░" or "é")
+    size_t const frequencies[] = { 0, 80, 16, 4 };
+
+    printf("%-24s %17s %17s\n", "text", "scan", "table");
+
+    for (size_t i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]); i++) {
+        size_t const frequency = frequencies[i];
+
+        fill(text, TEXT_LENGTH, frequency);
+
+        lookup_scan(codepage, text, TEXT_LENGTH, expected);
+        lookup_table(codepage, text, TEXT_LENGTH, actual);
+
+        if (memcmp(expected, actual, sizeof(uint8_t) * TEXT_LENGTH) != 0) {
+            printf("mismatch between scanned and tabled lookups\n");
+
+            exit(EXIT_FAILURE);
+        }
+
+        char label[48];
+
+        if (frequency == 0) {
+            snprintf(label, sizeof(label), "ascii");
+        } else {
+            snprintf(label, sizeof(label), "symbol every %zu chars",
+                     frequency);
+        }
+
+        printf("%-24s %7.0f Mlookup/s %7.0f Mlookup/s\n", label,
+               measure(lookup_scan, codepage, text, TEXT_LENGTH, expected),
+               measure(lookup_table, codepage, text, TEXT_LENGTH, actual));
+    }
+
+    codepage_release(codepage);
+
+    free(text);
+    free(expected);
+    free(actual);
+
+    return 0;
+}
+
+static
+void
+lookup_scan(struct codepage const * const codepage,
+            uint32_t const * const codes,
+            size_t const length,
+            uint8_t * const indices)
+{
+    (void)codepage;
+
+    for (size_t i = 0; i < length; i++) {
+        indices[i] = scan_index(codes[i]);
+    }
+}
+
+static
+void
+lookup_table(struct codepage const * const codepage,
+             uint32_t const * const codes,
+             size_t const length,
+             uint8_t * const indices)
+{
+    for (size_t i = 0; i < length; i++) {
+        indices[i] = codepage_index(codepage, codes[i]);
+    }
+}
+
+static
+uint8_t
+scan_index(uint32_t const code)
+{
+    // the lookup as it was prior to using tables
+    if (code >= 33 &&
+        code <= 126) {
+        // within basic ASCII range; skip mapping
+        return (uint8_t)code;
+    }
+
+    for (uint16_t i = 0; i < 33; i++) {
+        if (CP437[i] == code) {
+            return (uint8_t)i;
+        }
+    }
+
+    for (uint16_t i = 127; i < CP437_LENGTH; i++) {
+        if (CP437[i] == code) {
+            return (uint8_t)i;
+        }
+    }
+
+    return CODEPAGE_UNKNOWN;
+}
+
+static
+void
+fill(uint32_t * const text,
+     size_t const length,
+     size_t const symbol_frequency)
+{
+    uint32_t const symbols[] = {
+        // box drawing: ─│┌┐└┘├┤
+        0x2500, 0x2502, 0x250C, 0x2510, 0x2514, 0x2518, 0x251C, 0x2524,
+        // blocks: █▓▒░
+        0x2588, 0x2593, 0x2592, 0x2591,
+        // accented letters: éüñÅ
+        0x00E9, 0x00FC, 0x00F1, 0x00C5
+    };
+
+    size_t const symbol_count = sizeof(symbols) / sizeof(symbols[0]);
+
+    for (size_t i = 0; i < length; i++) {
+        size_t const n = i + 1;
+
+        if (symbol_frequency > 0 && n % symbol_frequency == 0) {
+            text[i] = symbols[(n / symbol_frequency) % symbol_count];
+        } else {
+            text[i] = (uint32_t)(' ' + (n % 94));
+        }
+    }
+}
+
+static
+double
+measure(lookup_func * const lookup,
+        struct codepage const * const codepage,
+        uint32_t const * const codes,
+        size_t const length,
+        uint8_t * const indices)
+{
+    size_t checksum = 0;
+
+    clock_t const start = clock();
+
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        lookup(codepage, codes, length, indices);
+
+        checksum += indices[i % length];
+    }
+
+    clock_t const end = clock();
+
+    double const seconds = (double)(end - start) / CLOCKS_PER_SEC;
+    double const lookups = ((double)length * ITERATIONS) / (1000 * 1000);
+
+    if (checksum == 0) {
+        // never happens; keeps lookups from being optimized away
+        printf("\n");
+    }
+
+    return seconds > 0 ? lookups / seconds : 0;
+}
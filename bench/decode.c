@@ -0,0 +1,198 @@
+#include "decode.h" // decode_utf8, decode_count
+
+#include <utf8.h> // utf8_decode
+
+#include <stdio.h> // printf
+#include <stdlib.h> // malloc, calloc, free, exit, EXIT_FAILURE
+#include <stdint.h> // uint32_t, int32_t
+#include <stddef.h> // size_t
+
+#include <string.h> // memcpy, memcmp
+#include <time.h> // clock, clock_t, CLOCKS_PER_SEC
+
+/**
+ * The size (in bytes) of text decoded on each iteration.
+ */
+#define TEXT_SIZE (4 * 1024)
+/**
+ * The number of times text is decoded per measurement.
+ */
+#define ITERATIONS 20000
+/**
+ * The number of zero bytes following text.
+ *
+ * Only needed by the scalar decoder, which always reads 4 bytes at a time
+ * (see utf8.h).
+ */
+#define SCALAR_PADDING 3
+
+/**
+ * Represents a function that decodes text into codepoints.
+ */
+typedef size_t decode_func(char const *, size_t, uint32_t *);
+
+static size_t decode_scalar(char const *, size_t, uint32_t *);
+static size_t decode_vectorized(char const *, size_t, uint32_t *);
+static size_t count_vectorized(char const *, size_t, uint32_t *);
+
+static void fill(char *, size_t size, size_t box_frequency);
+static double measure(decode_func *, char const *, size_t, uint32_t *);
+
+int
+main(void)
+{
+    char * const text = calloc(TEXT_SIZE + SCALAR_PADDING, 1);
+
+    uint32_t * const expected = malloc(sizeof(uint32_t) * TEXT_SIZE);
+    uint32_t * const actual = malloc(sizeof(uint32_t) * TEXT_SIZE);
+
+    // plain ASCII, then ASCII with increasingly frequent box-drawing
+    // characters (3 bytes each; e.g. "─")
+    size_t const frequencies[] = { 0, 80, 16, 4 };
+
+    printf("%-24s %12s %12s %12s\n", "text", "scalar", "vectorized", "count");
+
+    for (size_t i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]); i++) {
+        size_t const frequency = frequencies[i];
+
+        fill(text, TEXT_SIZE, frequency);
+
+        size_t const count = decode_scalar(text, TEXT_SIZE, expected);
+
+        if (decode_vectorized(text, TEXT_SIZE, actual) != count ||
+            memcmp(expected, actual, sizeof(uint32_t) * count) != 0) {
+            printf("mismatch between scalar and vectorized decoding\n");
+
+            exit(EXIT_FAILURE);
+        }
+
+        if (count_vectorized(text, TEXT_SIZE, actual) != count) {
+            printf("mismatch between decoding and counting\n");
+
+            exit(EXIT_FAILURE);
+        }
+
+        char label[48];
+
+        if (frequency == 0) {
+            snprintf(label, sizeof(label), "ascii");
+        } else {
+            snprintf(label, sizeof(label), "box every %zu chars", frequency);
+        }
+
+        printf("%-24s %7.0f MB/s %7.0f MB/s %7.0f MB/s\n", label,
+               measure(decode_scalar, text, TEXT_SIZE, expected),
+               measure(decode_vectorized, text, TEXT_SIZE, actual),
+               measure(count_vectorized, text, TEXT_SIZE, actual));
+    }
+
+    free(text);
+    free(expected);
+    free(actual);
+
+    return 0;
+}
+
+static
+size_t
+decode_scalar(char const * const text,
+              size_t const size,
+              uint32_t * const codepoints)
+{
+    int32_t error = 0;
+    size_t count = 0;
+
+    char const * next = text;
+
+    while (next < text + size) {
+        next = utf8_decode((void *)next, &codepoints[count], &error);
+
+        count += 1;
+    }
+
+    return count;
+}
+
+static
+size_t
+decode_vectorized(char const * const text,
+                  size_t const size,
+                  uint32_t * const codepoints)
+{
+    int32_t error = 0;
+
+    return decode_utf8(text, size, codepoints, 0, &error);
+}
+
+static
+size_t
+count_vectorized(char const * const text,
+                 size_t const size,
+                 uint32_t * const codepoints)
+{
+    // nothing is decoded; counting only
+    (void)codepoints;
+
+    return decode_count(text, size, NULL);
+}
+
+static
+void
+fill(char * const text,
+     size_t const size,
+     size_t const box_frequency)
+{
+    char const * const box = "─";
+
+    size_t i = 0;
+    size_t n = 0;
+
+    while (i + 3 <= size) {
+        n += 1;
+
+        if (box_frequency > 0 && n % box_frequency == 0) {
+            memcpy(&text[i], box, 3);
+
+            i += 3;
+        } else {
+            text[i] = (char)(' ' + (n % 94));
+
+            i += 1;
+        }
+    }
+
+    while (i < size) {
+        text[i] = '.';
+
+        i += 1;
+    }
+}
+
+static
+double
+measure(decode_func * const decode,
+        char const * const text,
+        size_t const size,
+        uint32_t * const codepoints)
+{
+    size_t checksum = 0;
+
+    clock_t const start = clock();
+
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        checksum += decode(text, size, codepoints);
+        checksum += codepoints[i % 64];
+    }
+
+    clock_t const end = clock();
+
+    double const seconds = (double)(end - start) / CLOCKS_PER_SEC;
+    double const megabytes = ((double)size * ITERATIONS) / (1024 * 1024);
+
+    if (checksum == 0) {
+        // never happens; keeps decoding from being optimized away
+        printf("\n");
+    }
+
+    return seconds > 0 ? megabytes / seconds : 0;
+}
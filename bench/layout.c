@@ -0,0 +1,278 @@
+#include "layout.h" // layout, layout_glyph, layout_*
+#include "buffer.h" // buffer, buffer_*
+
+#include <termlike/graphics/codepage.h> // codepage, codepage_*, CODEPAGE_*
+#include <termlike/bounds.h> // term_bounds, TERM_*
+
+#include <termlike/resources/cp437.h> // CP437, CP437_LENGTH
+
+#include <stdio.h> // printf
+#include <stdlib.h> // exit, EXIT_FAILURE
+#include <stdint.h> // uint8_t, uint32_t, int32_t
+#include <stddef.h> // size_t
+
+#include <string.h> // memcmp
+#include <math.h> // floorf
+#include <time.h> // clock, clock_t, CLOCKS_PER_SEC
+
+/**
+ * The number of panels laid out per measurement.
+ */
+#define ITERATIONS 100000
+/**
+ * The dimensions (in pixels) of a character.
+ */
+#define CHARACTER_SIZE 8.0f
+
+/**
+ * Provides values for measuring, or laying out, lines one pass at a time.
+ */
+struct bench_state {
+    struct layout * layout;
+    struct term_bounds bounds;
+};
+
+/**
+ * Represents a function that lays out the lines of a buffer.
+ */
+typedef void layout_func(struct layout *,
+                         struct buffer const *,
+                         struct term_bounds);
+
+static void layout_separately(struct layout *,
+                              struct buffer const *,
+                              struct term_bounds);
+static void layout_fused(struct layout *,
+                         struct buffer const *,
+                         struct term_bounds);
+
+static void measure_line(uint8_t const *, size_t, uint32_t, void *);
+static void layout_line(uint8_t const *, size_t, uint32_t, void *);
+
+static double measure(layout_func *,
+                      struct layout *,
+                      struct buffer *,
+                      struct codepage const *,
+                      char const * text,
+                      struct term_bounds);
+static float align(struct layout const *, struct term_bounds);
+
+int
+main(void)
+{
+    struct codepage * const codepage = codepage_init(CP437, CP437_LENGTH);
+    struct buffer * const buffer = buffer_init();
+
+    struct layout expected;
+    struct layout actual;
+
+    layout_init(&expected);
+    layout_init(&actual);
+
+    // a panel of text, as could be seen in a status or dialog window
+    char const * const text =
+        "The lantern flickers. Somewhere beyond the door, water drips onto "
+        "stone in a slow, steady rhythm.\n"
+        "You have: a rusty key, 3 torches, a map of the lower halls.\n"
+        "┌────────┐\n"
+        "│ HP ███▓▒░ │\n"
+        "└────────┘\n"
+        "Which way will you go?";
+
+    enum term_align const alignments[] = {
+        TERM_ALIGN_LEFT,
+        TERM_ALIGN_RIGHT,
+        TERM_ALIGN_CENTER
+    };
+
+    char const * const labels[] = {
+        "left", "right", "center"
+    };
+
+    printf("%-24s %17s %17s\n", "panel", "separate", "fused");
+
+    for (size_t i = 0; i < sizeof(alignments) / sizeof(alignments[0]); i++) {
+        // 32x12 characters; wrapped on words
+        struct term_bounds bounds = boxed(32 * (int32_t)CHARACTER_SIZE,
+                                          12 * (int32_t)CHARACTER_SIZE,
+                                          alignments[i]);
+
+        buffer_copy(buffer, codepage, text, bounds.limit);
+        buffer_wrap(buffer, 32, bounds.wrap);
+
+        layout_clear(&expected);
+        layout_clear(&actual);
+
+        layout_separately(&expected, buffer, bounds);
+        layout_fused(&actual, buffer, bounds);
+
+        if (expected.glyph_count != actual.glyph_count ||
+            expected.line_count != actual.line_count ||
+            expected.size.width != actual.size.width ||
+            expected.size.height != actual.size.height ||
+            memcmp(expected.glyphs, actual.glyphs,
+                   sizeof(struct layout_glyph) * actual.glyph_count) != 0 ||
+            memcmp(expected.line_widths, actual.line_widths,
+                   sizeof(int32_t) * actual.line_count) != 0) {
+            printf("mismatch between separate and fused layouts\n");
+
+            exit(EXIT_FAILURE);
+        }
+
+        printf("%-24s %7.0f panels/ms %7.0f panels/ms\n", labels[i],
+               measure(layout_separately, &expected,
+                       buffer, codepage, text, bounds),
+               measure(layout_fused, &actual,
+                       buffer, codepage, text, bounds));
+    }
+
+    layout_release(&expected);
+    layout_release(&actual);
+
+    buffer_release(buffer);
+    codepage_release(codepage);
+
+    return 0;
+}
+
+static
+void
+layout_separately(struct layout * const layout,
+                  struct buffer const * const buffer,
+                  struct term_bounds const bounds)
+{
+    // the layout as it was prior to fusing passes; i.e. first measure every
+    // line, character by character, then lay out every line
+    struct bench_state state;
+
+    state.layout = layout;
+    state.bounds = bounds;
+
+    buffer_foreach_line(buffer, measure_line, &state);
+
+    layout->size.height =
+        (int32_t)floorf((float)layout->line_count * CHARACTER_SIZE);
+
+    buffer_foreach_line(buffer, layout_line, &state);
+}
+
+static
+void
+layout_fused(struct layout * const layout,
+             struct buffer const * const buffer,
+             struct term_bounds const bounds)
+{
+    layout_buffer(layout, buffer, bounds, CHARACTER_SIZE, CHARACTER_SIZE);
+}
+
+static
+void
+measure_line(uint8_t const * const indices,
+             size_t const count,
+             uint32_t const line,
+             void * const data)
+{
+    (void)indices;
+    (void)line;
+
+    struct bench_state * const state = (struct bench_state *)data;
+
+    float edge = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        edge += CHARACTER_SIZE;
+    }
+
+    layout_add_line(state->layout, (int32_t)floorf(edge));
+}
+
+static
+void
+layout_line(uint8_t const * const indices,
+            size_t const count,
+            uint32_t const line,
+            void * const data)
+{
+    struct bench_state * const state = (struct bench_state *)data;
+
+    float const y = (float)line * CHARACTER_SIZE;
+
+    if (y + CHARACTER_SIZE > (float)state->bounds.size.height) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (indices[i] == CODEPAGE_SPACE) {
+            continue;
+        }
+
+        layout_add_glyph(state->layout, (struct layout_glyph) {
+            .x = (float)i * CHARACTER_SIZE,
+            .y = y,
+            .line = line,
+            .index = indices[i]
+        });
+    }
+}
+
+static
+double
+measure(layout_func * const lay_out,
+        struct layout * const layout,
+        struct buffer * const buffer,
+        struct codepage const * const codepage,
+        char const * const text,
+        struct term_bounds const bounds)
+{
+    float checksum = 0;
+
+    clock_t const start = clock();
+
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        // everything a print goes through before its glyphs are drawn
+        buffer_copy(buffer, codepage, text, bounds.limit);
+        buffer_wrap(buffer, 32, bounds.wrap);
+
+        layout_clear(layout);
+
+        lay_out(layout, buffer, bounds);
+
+        checksum += align(layout, bounds);
+    }
+
+    clock_t const end = clock();
+
+    double const milliseconds = (double)(end - start) * 1000 / CLOCKS_PER_SEC;
+
+    if (checksum == 0) {
+        // never happens; keeps layouts from being optimized away
+        printf("\n");
+    }
+
+    return milliseconds > 0 ? ITERATIONS / milliseconds : 0;
+}
+
+static
+float
+align(struct layout const * const layout,
+      struct term_bounds const bounds)
+{
+    float sum = 0;
+
+    // offset each glyph by the width of its line, as when printing
+    for (size_t i = 0; i < layout->glyph_count; i++) {
+        struct layout_glyph const glyph = layout->glyphs[i];
+
+        float x = glyph.x;
+
+        if (bounds.align == TERM_ALIGN_RIGHT) {
+            x -= (float)layout->line_widths[glyph.line];
+        } else if (bounds.align == TERM_ALIGN_CENTER) {
+            x -= (float)layout->line_widths[glyph.line] / 2.0f;
+        }
+
+        sum += x + glyph.y;
+    }
+
+    return sum;
+}
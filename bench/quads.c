@@ -0,0 +1,504 @@
+#include "graphics/opengl/renderable.h" // glyph_vertex, glyph_uv, texture, vector2, vector3
+#include "graphics/opengl/quad.h" // glyph_transform, glyph_rotation, glyphs_*
+
+#include <linmath/linmath.h> // mat4x4, mat4x4_*, vec4
+
+#include <stdio.h> // printf
+#include <stdlib.h> // malloc, free, rand, srand, exit, EXIT_FAILURE
+#include <stdint.h> // uint16_t, uint32_t, UINT16_MAX
+#include <stddef.h> // size_t
+#include <stdbool.h> // bool
+
+#include <float.h> // FLT_EPSILON
+#include <math.h> // fabsf
+#include <time.h> // clock, clock_t, CLOCKS_PER_SEC
+
+/**
+ * The number of glyphs expanded per iteration.
+ */
+#define GLYPH_COUNT 4096
+/**
+ * The number of times all glyphs are expanded per measurement.
+ */
+#define ITERATIONS 500
+/**
+ * The number of vertices per glyph when drawn as a plain list of triangles
+ * (i.e. without indices); 3 for each of the 2 triangles of a quad.
+ */
+#define TRIANGLE_VERTEX_COUNT 6
+
+/**
+ * Represents a function that transforms the vertices of a set of glyphs.
+ */
+typedef void transform_func(struct glyph_transform const *,
+                            size_t,
+                            struct glyph_vertex *);
+
+static void transform_matrices(struct glyph_transform const *,
+                               size_t,
+                               struct glyph_vertex *);
+static void transform_closed(struct glyph_transform const *,
+                             size_t,
+                             struct glyph_vertex *);
+
+static void transform_matrix(struct glyph_transform,
+                             struct glyph_vertex const *,
+                             size_t vertex_count,
+                             struct glyph_vertex * transformed);
+
+static void expand_triangles(struct glyph_transform const *,
+                             struct glyph_uv const *,
+                             size_t,
+                             struct glyph_vertex *);
+static void expand_quads(struct glyph_transform const *,
+                         struct glyph_uv const *,
+                         size_t,
+                         uint32_t const * indices,
+                         struct glyph_vertex *);
+
+static bool nearly_equals(float expected,
+                          float actual,
+                          struct glyph_transform);
+static bool vertex_nearly_equals(struct glyph_vertex expected,
+                                 struct glyph_vertex actual,
+                                 struct glyph_transform);
+
+static void fill(struct glyph_transform *, size_t count, size_t frequency);
+static void fill_uvs(struct glyph_uv *, size_t count);
+static float random_between(float min, float max);
+static double measure(transform_func *,
+                      struct glyph_transform const *,
+                      size_t,
+                      struct glyph_vertex *);
+
+int
+main(void)
+{
+    struct glyph_transform * const transforms =
+        malloc(sizeof(struct glyph_transform) * GLYPH_COUNT);
+
+    struct glyph_vertex * const expected =
+        malloc(sizeof(struct glyph_vertex) * GLYPH_VERTEX_COUNT * GLYPH_COUNT);
+    struct glyph_vertex * const actual =
+        malloc(sizeof(struct glyph_vertex) * GLYPH_VERTEX_COUNT * GLYPH_COUNT);
+
+    struct glyph_uv * const uvs = malloc(sizeof(struct glyph_uv) * GLYPH_COUNT);
+
+    uint32_t * const indices =
+        malloc(sizeof(uint32_t) * GLYPH_INDEX_COUNT * GLYPH_COUNT);
+
+    struct glyph_vertex * const expected_triangles =
+        malloc(sizeof(struct glyph_vertex) * TRIANGLE_VERTEX_COUNT * GLYPH_COUNT);
+    struct glyph_vertex * const actual_triangles =
+        malloc(sizeof(struct glyph_vertex) * TRIANGLE_VERTEX_COUNT * GLYPH_COUNT);
+
+    // the indices as uploaded for a batch of glyphs
+    glyphs_index(indices, GLYPH_COUNT);
+
+    srand(1);
+
+    fill_uvs(uvs, GLYPH_COUNT);
+
+    // no glyphs scaled or rotated, then increasingly many of them
+    size_t const frequencies[] = { 0, 16, 4, 1 };
+
+    printf("%-24s %17s %17s\n", "glyphs", "matrices", "closed");
+
+    for (size_t i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]); i++) {
+        size_t const frequency = frequencies[i];
+
+        fill(transforms, GLYPH_COUNT, frequency);
+
+        transform_matrices(transforms, GLYPH_COUNT, expected);
+        transform_closed(transforms, GLYPH_COUNT, actual);
+
+        // the closed form multiplies and adds in a different order than the
+        // matrices did, so results are only expected to match within the
+        // precision of a float; not bit for bit
+        for (size_t j = 0; j < GLYPH_VERTEX_COUNT * GLYPH_COUNT; j++) {
+            struct glyph_transform const transform =
+                transforms[j / GLYPH_VERTEX_COUNT];
+
+            if (!nearly_equals(expected[j].position.x,
+                               actual[j].position.x, transform) ||
+                !nearly_equals(expected[j].position.y,
+                               actual[j].position.y, transform) ||
+                !nearly_equals(expected[j].position.z,
+                               actual[j].position.z, transform)) {
+                printf("mismatch between matrix and closed transforms\n");
+
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        expand_triangles(transforms, uvs, GLYPH_COUNT, expected_triangles);
+        expand_quads(transforms, uvs, GLYPH_COUNT, indices, actual_triangles);
+
+        // triangles are compared corner by corner; i.e. both the order of
+        // corners and the indices must result in the same triangles
+        for (size_t j = 0; j < TRIANGLE_VERTEX_COUNT * GLYPH_COUNT; j++) {
+            if (!vertex_nearly_equals(expected_triangles[j],
+                                      actual_triangles[j],
+                                      transforms[j / TRIANGLE_VERTEX_COUNT])) {
+                printf("mismatch between listed and indexed triangles\n");
+
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        char label[48];
+
+        if (frequency == 0) {
+            snprintf(label, sizeof(label), "unchanged");
+        } else {
+            snprintf(label, sizeof(label), "transformed 1 in %zu", frequency);
+        }
+
+        printf("%-24s %8.1f Mglyph/s %8.1f Mglyph/s\n", label,
+               measure(transform_matrices, transforms, GLYPH_COUNT, expected),
+               measure(transform_closed, transforms, GLYPH_COUNT, actual));
+    }
+
+    free(transforms);
+    free(expected);
+    free(actual);
+    free(uvs);
+    free(indices);
+    free(expected_triangles);
+    free(actual_triangles);
+
+    return 0;
+}
+
+static
+void
+transform_matrices(struct glyph_transform const * const transforms,
+                   size_t const count,
+                   struct glyph_vertex * const transformed)
+{
+    for (size_t i = 0; i < count; i++) {
+        struct glyph_vertex vertices[GLYPH_VERTEX_COUNT];
+
+        glyphs_set_corners(&vertices, transforms[i].offset);
+
+        transform_matrix(transforms[i], vertices, GLYPH_VERTEX_COUNT,
+                         &transformed[i * GLYPH_VERTEX_COUNT]);
+    }
+}
+
+static
+void
+transform_closed(struct glyph_transform const * const transforms,
+                 size_t const count,
+                 struct glyph_vertex * const transformed)
+{
+    struct glyph_rotation rotation = GLYPH_ROTATION_NONE;
+
+    for (size_t i = 0; i < count; i++) {
+        struct glyph_transform const transform = transforms[i];
+
+        struct glyph_vertex vertices[GLYPH_VERTEX_COUNT];
+
+        glyphs_set_corners(&vertices, transform.offset);
+
+        glyphs_rotate(&rotation, transform.angle);
+        glyphs_transform((struct glyph_vertex const (*)[GLYPH_VERTEX_COUNT])
+                            &vertices,
+                         transform,
+                         rotation,
+                         (struct glyph_vertex (*)[GLYPH_VERTEX_COUNT])
+                            &transformed[i * GLYPH_VERTEX_COUNT]);
+    }
+}
+
+static
+void
+transform_matrix(struct glyph_transform const transform,
+                 struct glyph_vertex const * const vertices,
+                 size_t const vertex_count,
+                 struct glyph_vertex * const transformed)
+{
+    // the transformation as it was prior to the closed form; i.e. building,
+    // and multiplying, matrices for each scaled or rotated glyph
+    bool const requires_scaling = (transform.scale.x > 1 ||
+                                   transform.scale.x < 1 ||
+                                   transform.scale.y > 1 ||
+                                   transform.scale.y < 1);
+
+    bool const requires_rotation = (transform.angle > 0 ||
+                                    transform.angle < 0);
+
+    bool const requires_transformation = (requires_scaling ||
+                                          requires_rotation);
+
+    mat4x4 transformation;
+
+    if (requires_transformation) {
+        mat4x4 translated;
+        mat4x4_identity(translated);
+        mat4x4_translate(translated,
+                         transform.origin.x,
+                         transform.origin.y,
+                         transform.origin.z);
+
+        mat4x4 rotated;
+        mat4x4_identity(rotated);
+
+        if (requires_rotation) {
+            mat4x4_rotate_Z(rotated, rotated,
+                            transform.angle);
+        }
+
+        mat4x4 scaled;
+        mat4x4_identity(scaled);
+
+        if (requires_scaling) {
+            mat4x4_scale_aniso(scaled, scaled,
+                               transform.scale.x,
+                               transform.scale.y,
+                               1);
+        }
+
+        mat4x4_mul(transformation, translated, rotated);
+        mat4x4_mul(transformation, transformation, scaled);
+    }
+
+    for (size_t i = 0; i < vertex_count; i++) {
+        struct glyph_vertex vertex = vertices[i];
+
+        if (requires_transformation) {
+            vec4 position = {
+                vertex.position.x,
+                vertex.position.y,
+                vertex.position.z,
+                1
+            };
+
+            vec4 world_position;
+
+            mat4x4_mul_vec4(world_position, transformation, position);
+
+            vertex.position = (struct vector3) {
+                world_position[0] + transform.offset.x,
+                world_position[1] + transform.offset.y,
+                world_position[2]
+            };
+        } else {
+            vertex.position = (struct vector3) {
+                vertex.position.x + transform.origin.x + transform.offset.x,
+                vertex.position.y + transform.origin.y + transform.offset.y,
+                vertex.position.z + transform.origin.z
+            };
+        }
+
+        transformed[i] = vertex;
+    }
+}
+
+static
+void
+expand_triangles(struct glyph_transform const * const transforms,
+                 struct glyph_uv const * const uvs,
+                 size_t const count,
+                 struct glyph_vertex * const triangles)
+{
+    // the expansion as it was prior to indexing; i.e. 6 vertices per glyph,
+    // repeating the 2 corners shared by both triangles
+    for (size_t i = 0; i < count; i++) {
+        float const l = -transforms[i].offset.x;
+        float const r = transforms[i].offset.x;
+        float const b = -transforms[i].offset.y;
+        float const t = transforms[i].offset.y;
+
+        struct vector3 const tl = { .x = l, .y = t, .z = 0 };
+        struct vector3 const tr = { .x = r, .y = t, .z = 0 };
+        struct vector3 const bl = { .x = l, .y = b, .z = 0 };
+        struct vector3 const br = { .x = r, .y = b, .z = 0 };
+
+        struct texture const uv_bl = uvs[i].min;
+        struct texture const uv_tr = uvs[i].max;
+        struct texture const uv_tl = { .u = uvs[i].min.u, .v = uvs[i].max.v };
+        struct texture const uv_br = { .u = uvs[i].max.u, .v = uvs[i].min.v };
+
+        struct glyph_vertex vertices[TRIANGLE_VERTEX_COUNT] = {
+            { .position = tl, .texture = uv_tl },
+            { .position = br, .texture = uv_br },
+            { .position = bl, .texture = uv_bl },
+
+            { .position = tl, .texture = uv_tl },
+            { .position = tr, .texture = uv_tr },
+            { .position = br, .texture = uv_br }
+        };
+
+        transform_matrix(transforms[i], vertices, TRIANGLE_VERTEX_COUNT,
+                         &triangles[i * TRIANGLE_VERTEX_COUNT]);
+    }
+}
+
+static
+void
+expand_quads(struct glyph_transform const * const transforms,
+             struct glyph_uv const * const uvs,
+             size_t const count,
+             uint32_t const * const indices,
+             struct glyph_vertex * const triangles)
+{
+    struct glyph_vertex * const quads =
+        malloc(sizeof(struct glyph_vertex) * GLYPH_VERTEX_COUNT * count);
+
+    struct glyph_rotation rotation = GLYPH_ROTATION_NONE;
+
+    for (size_t i = 0; i < count; i++) {
+        struct glyph_vertex vertices[GLYPH_VERTEX_COUNT];
+
+        glyphs_set_corners(&vertices, transforms[i].offset);
+        glyphs_set_uvs(&vertices, uvs[i]);
+
+        glyphs_rotate(&rotation, transforms[i].angle);
+        glyphs_transform((struct glyph_vertex const (*)[GLYPH_VERTEX_COUNT])
+                            &vertices,
+                         transforms[i],
+                         rotation,
+                         (struct glyph_vertex (*)[GLYPH_VERTEX_COUNT])
+                            &quads[i * GLYPH_VERTEX_COUNT]);
+    }
+
+    // resolve indices just as the GPU would
+    for (size_t i = 0; i < GLYPH_INDEX_COUNT * count; i++) {
+        triangles[i] = quads[indices[i]];
+    }
+
+    free(quads);
+}
+
+static
+bool
+nearly_equals(float const expected,
+              float const actual,
+              struct glyph_transform const transform)
+{
+    // rounding errors are relative to the largest term summed up, not to the
+    // result; e.g. a corner rotated back onto the origin
+    float const magnitude = 1 +
+        fabsf(transform.origin.x) +
+        fabsf(transform.origin.y) +
+        fabsf(transform.origin.z) +
+        2 * (fabsf(transform.offset.x) + fabsf(transform.offset.y)) *
+            (fabsf(transform.scale.x) + fabsf(transform.scale.y));
+
+    return fabsf(expected - actual) <= magnitude * 8 * FLT_EPSILON;
+}
+
+static
+bool
+vertex_nearly_equals(struct glyph_vertex const expected,
+                     struct glyph_vertex const actual,
+                     struct glyph_transform const transform)
+{
+    return (nearly_equals(expected.position.x, actual.position.x, transform) &&
+            nearly_equals(expected.position.y, actual.position.y, transform) &&
+            nearly_equals(expected.position.z, actual.position.z, transform) &&
+            expected.texture.u == actual.texture.u &&
+            expected.texture.v == actual.texture.v);
+}
+
+static
+void
+fill(struct glyph_transform * const transforms,
+     size_t const count,
+     size_t const frequency)
+{
+    float const pi = 3.14159265358979f;
+
+    for (size_t i = 0; i < count; i++) {
+        // glyphs of 8 to 32 pixels, anywhere on a 1080p display
+        float const size = random_between(8, 32);
+
+        transforms[i] = (struct glyph_transform) {
+            .origin = {
+                .x = random_between(0, 1920),
+                .y = random_between(0, 1080),
+                .z = random_between(0, 1)
+            },
+            .offset = {
+                .x = size / 2,
+                .y = size / 2
+            },
+            .scale = {
+                .x = 1,
+                .y = 1
+            },
+            .angle = 0
+        };
+
+        if (frequency > 0 && (i + 1) % frequency == 0) {
+            // either scaled, rotated or both
+            int const kind = rand() % 3;
+
+            if (kind != 1) {
+                transforms[i].scale.x = random_between(0.25f, 4);
+                transforms[i].scale.y = random_between(0.25f, 4);
+            }
+
+            if (kind != 0) {
+                transforms[i].angle = random_between(-2 * pi, 2 * pi);
+            }
+        }
+    }
+}
+
+static
+void
+fill_uvs(struct glyph_uv * const uvs, size_t const count)
+{
+    for (size_t i = 0; i < count; i++) {
+        // any rectangle will do; corners only need to be told apart
+        uint16_t const u = (uint16_t)(rand() % (UINT16_MAX / 2));
+        uint16_t const v = (uint16_t)(rand() % (UINT16_MAX / 2));
+
+        uvs[i] = (struct glyph_uv) {
+            .min = { .u = u, .v = v },
+            .max = {
+                .u = (uint16_t)(u + 1 + rand() % (UINT16_MAX / 2)),
+                .v = (uint16_t)(v + 1 + rand() % (UINT16_MAX / 2))
+            }
+        };
+    }
+}
+
+static
+float
+random_between(float const min, float const max)
+{
+    return min + ((float)rand() / (float)RAND_MAX) * (max - min);
+}
+
+static
+double
+measure(transform_func * const transform,
+        struct glyph_transform const * const transforms,
+        size_t const count,
+        struct glyph_vertex * const transformed)
+{
+    float checksum = 0;
+
+    clock_t const start = clock();
+
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        transform(transforms, count, transformed);
+
+        checksum += transformed[i % count].position.x;
+    }
+
+    clock_t const end = clock();
+
+    double const seconds = (double)(end - start) / CLOCKS_PER_SEC;
+    double const glyphs = ((double)count * ITERATIONS) / (1000 * 1000);
+
+    if (checksum == 0) {
+        // never happens; keeps transformations from being optimized away
+        printf("\n");
+    }
+
+    return seconds > 0 ? glyphs / seconds : 0;
+}
@@ -0,0 +1,390 @@
+#include "internal.h" // term_layout_text
+#include "layout.h" // layout, layout_glyph, layout_*
+#include "buffer.h" // buffer, buffer_*
+
+#include <termlike/graphics/codepage.h> // codepage, codepage_*
+#include <termlike/bounds.h> // term_bounds, TERM_*
+#include <termlike/text.h> // term_text, term_*_text, term_text_*
+
+#include <termlike/resources/cp437.h> // CP437, CP437_LENGTH
+
+#include <stdio.h> // printf
+#include <stdlib.h> // malloc, free, rand, srand, exit, EXIT_FAILURE
+#include <stdint.h> // int32_t
+#include <stddef.h> // size_t
+#include <stdbool.h> // bool
+
+#include <string.h> // memcmp, memcpy, memmove, strlen, strcpy, strcat
+#include <time.h> // clock, clock_t, CLOCKS_PER_SEC
+
+/**
+ * The number of random edits checked against the model.
+ */
+#define EDITS 20000
+/**
+ * The number of edits between changing how the text is wrapped.
+ */
+#define EDITS_PER_WRAP 500
+/**
+ * The number of characters that the model can hold.
+ */
+#define MODEL_CAPACITY 4096
+/**
+ * The number of characters that a single edit inserts or erases at most.
+ */
+#define EDIT_LENGTH 24
+/**
+ * The number of paragraphs, and characters per paragraph, of the document
+ * that edits are measured on.
+ */
+#define DOCUMENT_PARAGRAPHS 200
+#define DOCUMENT_PARAGRAPH_LENGTH 60
+/**
+ * The number of edits per measurement.
+ */
+#define ITERATIONS 5000
+/**
+ * The dimensions (in pixels) of a character.
+ */
+#define CHARACTER_SIZE 8.0f
+
+/**
+ * Represents the plain string that a text is expected to hold.
+ *
+ * Each character is kept as the index of a token (see `tokens`), so that
+ * positions are in characters, just as for texts, while the string itself
+ * can be rebuilt as UTF-8.
+ */
+struct model {
+    size_t characters[MODEL_CAPACITY];
+    size_t length;
+};
+
+/**
+ * The characters that edits are made of; including linebreaks (that split
+ * and merge paragraphs), whitespace (that words are wrapped on) and
+ * characters encoded in more than a single byte.
+ */
+static char const * const tokens[] = {
+    "a", "b", "c", "d", "e", " ", " ", "\n", "\xC3\xA9", "\xE2\x94\x80"
+};
+
+#define TOKEN_COUNT (sizeof(tokens) / sizeof(tokens[0]))
+
+static void edit(struct term_text *, struct model *);
+static void check(struct term_text *,
+                  struct model const *,
+                  struct buffer *,
+                  struct codepage const *,
+                  struct term_bounds,
+                  size_t limit);
+static void model_to_string(struct model const *, char *);
+static bool layout_equals(struct layout const *, struct layout const *);
+
+static double measure_text(struct term_text *,
+                           struct codepage const *,
+                           struct term_bounds,
+                           size_t limit);
+static double measure_copied(struct buffer *,
+                             struct codepage const *,
+                             char const *,
+                             struct term_bounds,
+                             size_t limit);
+
+int
+main(void)
+{
+    struct codepage * const codepage = codepage_init(CP437, CP437_LENGTH);
+    struct buffer * const buffer = buffer_init();
+
+    struct term_text * const text = term_create_text();
+    struct model * const model = malloc(sizeof(struct model));
+
+    model->length = 0;
+
+    srand(1);
+
+    struct term_bounds bounds = TERM_BOUNDS_NONE;
+
+    size_t limit = 0;
+
+    for (size_t i = 0; i < EDITS; i++) {
+        if (i % EDITS_PER_WRAP == 0) {
+            // every paragraph is wrapped again whenever this changes
+            bounds.wrap = (rand() % 2 == 0 ? TERM_WRAP_WORDS :
+                                             TERM_WRAP_CHARACTERS);
+            bounds.size.height = (rand() % 2 == 0 ?
+                TERM_BOUNDS_UNBOUNDED :
+                (int32_t)(CHARACTER_SIZE * (float)(1 + rand() % 40)));
+
+            limit = (size_t)(rand() % 3 == 0 ? 0 : 1 + rand() % 32);
+        }
+
+        edit(text, model);
+
+        check(text, model, buffer, codepage, bounds, limit);
+
+        if (rand() % 8 == 0) {
+            // laying out again without edits must give the same layout
+            check(text, model, buffer, codepage, bounds, limit);
+        }
+    }
+
+    term_release_text(text);
+
+    free(model);
+
+    // a document of many paragraphs, each wrapped onto a couple of lines
+    size_t const paragraph_size = DOCUMENT_PARAGRAPH_LENGTH + 1;
+    char * const document = malloc(DOCUMENT_PARAGRAPHS * paragraph_size + 1);
+
+    for (size_t i = 0; i < DOCUMENT_PARAGRAPHS * paragraph_size; i++) {
+        size_t const n = i % paragraph_size;
+
+        if (n == DOCUMENT_PARAGRAPH_LENGTH) {
+            document[i] = '\n';
+        } else {
+            document[i] = (n % 7 == 6) ? ' ' : (char)('a' + n % 26);
+        }
+    }
+
+    document[DOCUMENT_PARAGRAPHS * paragraph_size] = '\0';
+
+    struct term_text * const edited = term_create_text();
+
+    term_text_insert(edited, 0, document);
+
+    bounds = TERM_BOUNDS_NONE;
+    bounds.wrap = TERM_WRAP_WORDS;
+
+    printf("%-24s %17s %17s\n", "document", "copied", "text");
+    printf("%-24s %9.0f edits/ms %9.0f edits/ms\n", "paragraphs",
+           measure_copied(buffer, codepage, document, bounds, 32),
+           measure_text(edited, codepage, bounds, 32));
+
+    term_release_text(edited);
+
+    free(document);
+
+    buffer_release(buffer);
+    codepage_release(codepage);
+
+    return 0;
+}
+
+static
+void
+edit(struct term_text * const text, struct model * const model)
+{
+    size_t const position = (size_t)rand() % (model->length + 2);
+    size_t count = 1 + (size_t)rand() % EDIT_LENGTH;
+
+    // keep the model from filling up; erase more often the longer it gets
+    bool const erasing = (size_t)(rand() % MODEL_CAPACITY) < model->length;
+
+    if (erasing) {
+        term_text_erase(text, position, count);
+
+        if (position < model->length) {
+            if (count > model->length - position) {
+                count = model->length - position;
+            }
+
+            memmove(&model->characters[position],
+                    &model->characters[position + count],
+                    sizeof(size_t) * (model->length - position - count));
+
+            model->length -= count;
+        }
+    } else {
+        char characters[EDIT_LENGTH * 4 + 1];
+        size_t inserted[EDIT_LENGTH];
+
+        characters[0] = '\0';
+
+        for (size_t i = 0; i < count; i++) {
+            inserted[i] = (size_t)rand() % TOKEN_COUNT;
+
+            strcat(characters, tokens[inserted[i]]);
+        }
+
+        term_text_insert(text, position, characters);
+
+        size_t const at = (position < model->length ? position :
+                                                      model->length);
+
+        memmove(&model->characters[at + count],
+                &model->characters[at],
+                sizeof(size_t) * (model->length - at));
+        memcpy(&model->characters[at], inserted, sizeof(size_t) * count);
+
+        model->length += count;
+    }
+}
+
+static
+void
+check(struct term_text * const text,
+      struct model const * const model,
+      struct buffer * const buffer,
+      struct codepage const * const codepage,
+      struct term_bounds const bounds,
+      size_t const limit)
+{
+    if (term_text_length(text) != model->length) {
+        printf("mismatch between text and model lengths\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    static char string[MODEL_CAPACITY * 4 + 1];
+
+    model_to_string(model, string);
+
+    struct layout expected;
+
+    layout_init(&expected);
+
+    // the layout as made when printing a string; i.e. copying, wrapping and
+    // laying out the whole string every time
+    buffer_copy(buffer, codepage, string, 0);
+    buffer_wrap(buffer, limit, bounds.wrap);
+
+    layout_buffer(&expected, buffer, bounds, CHARACTER_SIZE, CHARACTER_SIZE);
+
+    struct layout const * const actual =
+        term_layout_text(text, codepage, bounds, limit,
+                         CHARACTER_SIZE, CHARACTER_SIZE);
+
+    if (!layout_equals(&expected, actual)) {
+        printf("mismatch between text and copied string layouts\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    layout_release(&expected);
+}
+
+static
+void
+model_to_string(struct model const * const model, char * const string)
+{
+    size_t size = 0;
+
+    for (size_t i = 0; i < model->length; i++) {
+        char const * const token = tokens[model->characters[i]];
+
+        strcpy(&string[size], token);
+
+        size += strlen(token);
+    }
+
+    string[size] = '\0';
+}
+
+static
+bool
+layout_equals(struct layout const * const expected,
+              struct layout const * const actual)
+{
+    if (expected->glyph_count != actual->glyph_count ||
+        expected->line_count != actual->line_count ||
+        expected->size.width != actual->size.width ||
+        expected->size.height != actual->size.height ||
+        memcmp(expected->line_widths, actual->line_widths,
+               sizeof(int32_t) * actual->line_count) != 0) {
+        return false;
+    }
+
+    // glyphs are compared by member, as their padding is never initialized
+    for (size_t i = 0; i < actual->glyph_count; i++) {
+        struct layout_glyph const a = expected->glyphs[i];
+        struct layout_glyph const b = actual->glyphs[i];
+
+        if (a.x < b.x || a.x > b.x || a.y < b.y || a.y > b.y ||
+            a.line != b.line || a.index != b.index) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static
+double
+measure_text(struct term_text * const text,
+             struct codepage const * const codepage,
+             struct term_bounds const bounds,
+             size_t const limit)
+{
+    size_t checksum = 0;
+
+    // a single character typed, then erased, in the middle of the document
+    size_t const position = term_text_length(text) / 2;
+
+    clock_t const start = clock();
+
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        if (i % 2 == 0) {
+            term_text_insert(text, position, "x");
+        } else {
+            term_text_erase(text, position, 1);
+        }
+
+        checksum += term_layout_text(text, codepage, bounds, limit,
+                                     CHARACTER_SIZE,
+                                     CHARACTER_SIZE)->glyph_count;
+    }
+
+    clock_t const end = clock();
+
+    double const milliseconds = (double)(end - start) * 1000 / CLOCKS_PER_SEC;
+
+    if (checksum == 0) {
+        // never happens; keeps layouts from being optimized away
+        printf("\n");
+    }
+
+    return milliseconds > 0 ? ITERATIONS / milliseconds : 0;
+}
+
+static
+double
+measure_copied(struct buffer * const buffer,
+               struct codepage const * const codepage,
+               char const * const document,
+               struct term_bounds const bounds,
+               size_t const limit)
+{
+    size_t checksum = 0;
+
+    struct layout layout;
+
+    layout_init(&layout);
+
+    clock_t const start = clock();
+
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        // the edit itself is left out; only what a print goes through after
+        buffer_copy(buffer, codepage, document, 0);
+        buffer_wrap(buffer, limit, bounds.wrap);
+
+        layout_clear(&layout);
+        layout_buffer(&layout, buffer, bounds, CHARACTER_SIZE, CHARACTER_SIZE);
+
+        checksum += layout.glyph_count;
+    }
+
+    clock_t const end = clock();
+
+    layout_release(&layout);
+
+    double const milliseconds = (double)(end - start) * 1000 / CLOCKS_PER_SEC;
+
+    if (checksum == 0) {
+        // never happens; keeps layouts from being optimized away
+        printf("\n");
+    }
+
+    return milliseconds > 0 ? ITERATIONS / milliseconds : 0;
+}
@@ -0,0 +1,100 @@
+#include <termlike/termlike.h> // term_*
+
+#include <stdlib.h> // exit, malloc, free, rand, EXIT_FAILURE
+#include <stdint.h> // int32_t
+#include <stddef.h> // size_t
+#include <stdbool.h> // bool :completeness
+
+static struct term_cell * background = NULL;
+static struct term_cell * foreground = NULL;
+static struct term_transform * foreground_transforms = NULL;
+
+static struct term_dimens cell_size;
+
+static size_t columns = 0;
+static size_t count = 0;
+
+static
+void
+draw(double const interp)
+{
+    (void)interp;
+
+    for (size_t i = 0; i < count; i++) {
+        background[i] = (struct term_cell) {
+            .code = indexed(219), // '█'
+            .color = colored(rand() % 255, rand() % 255, rand() % 255)
+        };
+
+        foreground[i] = (struct term_cell) {
+            .code = 0x2022, // '•'
+            .color = transparent(colored(rand() % 255,
+                                         rand() % 255,
+                                         rand() % 255), rand() % 255)
+        };
+
+        foreground_transforms[i] = rotated(rand() % 360,
+                                           TERM_ROTATE_CHARACTERS);
+    }
+
+    // note that the grids must remain valid until the frame has been rendered;
+    // hence static
+    static struct term_grid background_grid;
+    static struct term_grid foreground_grid;
+
+    background_grid = gridded(background, count, columns, cell_size);
+    foreground_grid = gridded(foreground, count, columns, cell_size);
+
+    foreground_grid.transforms = foreground_transforms;
+
+    // the same amount of glyphs as the performance example, but printed
+    // as two commands rather than one command per glyph
+    term_print_cells(&background_grid, positionedz(0, 0, layered(0)));
+    term_print_cells(&foreground_grid, positionedz(0, 0, layered(1)));
+}
+
+int32_t
+main(void)
+{
+    struct term_settings settings = defaults("Termlike: Cells");
+
+    settings.vsync = false;
+    settings.pixel_size = 1;
+
+    if (!term_open(settings)) {
+        exit(EXIT_FAILURE);
+    }
+
+    struct term_dimens window;
+
+    term_get_display(&window);
+
+    term_measure("█", &cell_size);
+
+    columns = (size_t)(window.width / cell_size.width);
+    count = columns * (size_t)(window.height / cell_size.height);
+
+    background = malloc(sizeof(struct term_cell) * count);
+    foreground = malloc(sizeof(struct term_cell) * count);
+    foreground_transforms = malloc(sizeof(struct term_transform) * count);
+
+    term_set_drawing(draw);
+
+    srand(1234);
+
+    while (!term_is_closing()) {
+        if (term_key_down(TERM_KEY_ESCAPE)) {
+            term_set_closing(true);
+        }
+
+        term_run(TERM_FREQUENCY_NONE);
+    }
+
+    term_close();
+
+    free(background);
+    free(foreground);
+    free(foreground_transforms);
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <termlike/color.h> // term_color :completeness
+#include <termlike/bounds.h> // term_dimens :completeness
+#include <termlike/transform.h> // term_transform :completeness
+
+#include <stdint.h> // uint8_t, uint32_t
+#include <stddef.h> // size_t, NULL
+
+/**
+ * Flag that marks the code of a cell as a glyph index rather than a codepoint.
+ */
+#define TERM_CELL_INDEXED (0x80000000u)
+
+/**
+ * Represents a single glyph in a grid.
+ */
+struct term_cell {
+    /**
+     * The codepoint of the glyph (e.g. 0x2588 for '█').
+     *
+     * Alternatively, the index of the glyph in the codepage (see `indexed`).
+     *
+     * Cells holding whitespace or a zero codepoint are not printed.
+     */
+    uint32_t code;
+    /**
+     * The color of the glyph.
+     */
+    struct term_color color;
+};
+
+/**
+ * Represents a contiguous grid of cells.
+ *
+ * Cells are laid out row by row, going from left to right.
+ */
+struct term_grid {
+    /**
+     * A pointer to the cells of the grid.
+     */
+    struct term_cell const * cells;
+    /**
+     * A pointer to a transformation for each cell of the grid.
+     *
+     * If this pointer is NULL, the currently set glyph transformation is
+     * applied to all cells.
+     */
+    struct term_transform const * transforms;
+    /**
+     * The number of cells in the grid.
+     */
+    size_t count;
+    /**
+     * The number of cells in each row.
+     */
+    size_t columns;
+    /**
+     * The distance (in pixels) between each cell.
+     */
+    struct term_dimens pitch;
+};
+
+/**
+ * Return the cell code corresponding to a glyph index in the codepage.
+ *
+ * For example, `indexed(219)` for a full block ('█').
+ */
+inline
+uint32_t
+indexed(uint8_t const index)
+{
+    return TERM_CELL_INDEXED | index;
+}
+
+/**
+ * Return a grid of cells.
+ */
+inline
+struct term_grid
+gridded(struct term_cell const * const cells,
+        size_t const count,
+        size_t const columns,
+        struct term_dimens const pitch)
+{
+    return (struct term_grid) {
+        .cells = cells,
+        .transforms = NULL,
+        .count = count,
+        .columns = columns,
+        .pitch = pitch
+    };
+}
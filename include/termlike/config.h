@@ -2,7 +2,7 @@
 
 #include <termlike/bounds.h> // term_dimens :completeness
 
-#include <stdint.h> // uint8_t
+#include <stdint.h> // uint8_t, uint32_t
 #include <stdbool.h> // bool
 
 /**
@@ -24,6 +24,27 @@ struct term_settings {
     bool fullscreen;
     /** Determines whether v-sync should be enabled. */
     bool vsync;
+    /** Determines whether printed strings should be copied.
+     *
+     * Default is false. If enabled, strings (and grids) are copied when
+     * printed, so that they need not remain valid until the frame has been
+     * rendered; at the cost of copying them. */
+    bool copy_text;
+    /** Number of threads used for expanding glyphs into vertices.
+     *
+     * Default is 1. If higher, all glyphs of a frame are expanded in
+     * parallel (using additional threads) before being uploaded for
+     * rendering, rather than one at a time as each print is handled.
+     * This only pays off for frames holding many thousands of glyphs. */
+    uint8_t threads;
+    /** Maximum number of glyphs drawn in a single draw call.
+     *
+     * Default is 131072. Glyphs are batched into a buffer that grows to
+     * hold every glyph of a frame, so that a frame is typically drawn
+     * in a single draw call; this sets an upper bound on the size of
+     * that buffer. If a frame holds more glyphs, it is drawn in several
+     * draw calls instead. */
+    uint32_t max_glyphs;
 };
 
 /**
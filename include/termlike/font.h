@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h> // uint8_t
+
+/**
+ * Represents a font (or tileset) that glyphs can be printed with.
+ *
+ * Every font is a grid of 16x16 glyphs, laid out in the same order as the
+ * default font (CP437), so that characters map to glyphs the same way
+ * regardless of font.
+ *
+ * Any mix of fonts can be printed within a frame without affecting how many
+ * draw calls it takes to render it.
+ */
+struct term_font {
+    /**
+     * The id of the font.
+     */
+    uint8_t id;
+};
+
+/**
+ * The default font (IBM 8x8).
+ */
+extern struct term_font const TERM_FONT_DEFAULT;
@@ -6,9 +6,12 @@
 #include <termlike/position.h> // term_position :completeness
 #include <termlike/transform.h> // term_transform :completeness
 #include <termlike/color.h> // term_color :completeness
+#include <termlike/cell.h> // term_grid :completeness
+#include <termlike/text.h> // term_text :completeness
+#include <termlike/font.h> // term_font :completeness
 
 #include <stdbool.h> // bool
-#include <stdint.h> // uint16_t
+#include <stdint.h> // uint8_t, uint16_t, uint32_t
 #include <stddef.h> // size_t
 
 /**
@@ -132,6 +135,30 @@ void term_set_transform(struct term_transform);
  */
 void term_get_transform(struct term_transform *);
 
+/**
+ * Load a font (or tileset) from PNG image data, in addition to the default
+ * font.
+ *
+ * The image must hold a grid of 16x16 glyphs, each glyph being a square of
+ * the same size (in pixels).
+ *
+ * Return false if the image could not be loaded, if the image is not exactly
+ * 16 glyphs wide and 16 glyphs tall, or if no more fonts can be loaded (at
+ * most 16 fonts, including the default font).
+ */
+bool term_load_font(uint8_t const * data,
+                    size_t length,
+                    uint16_t glyph_size,
+                    struct term_font *);
+/**
+ * Set the font that glyphs are printed with.
+ */
+void term_set_font(struct term_font);
+/**
+ * Get the currently set font.
+ */
+void term_get_font(struct term_font *);
+
 /**
  * Print a character.
  *
@@ -175,12 +202,47 @@ void term_print(char const * character,
  *     ...
  *         static char buf[32];
  *     ...
+ *
+ * Alternatively, the terminal can be opened with the `copy_text` setting
+ * enabled, in which case every printed string is copied at the time of
+ * issuing the print, and the pointed-to string need not remain valid.
  */
 void term_printstr(char const * text,
                    struct term_position,
                    struct term_color,
                    struct term_bounds);
 
+/**
+ * Print a grid of cells.
+ *
+ * This is much cheaper than printing each cell individually, as the entire
+ * grid is issued as a single command, and no text needs to be decoded or laid
+ * out. All cells are printed on the same layer, beginning at the position of
+ * the grid.
+ *
+ * As with `term_printstr`, the caller is responsible for ensuring the
+ * validity of the pointed-to grid, as well as its cells and transformations,
+ * until `term_run` has ended.
+ */
+void term_print_cells(struct term_grid const *,
+                      struct term_position);
+
+/**
+ * Print an editable text (see text.h).
+ *
+ * This works just like `term_printstr`, except that only paragraphs that were
+ * edited since the text was last printed are wrapped again; and if nothing was
+ * edited, and neither bounds nor transformation changed, the previous layout
+ * is reused as-is. The character limit of the bounds does not apply.
+ *
+ * The text is printed as it is when the frame is drawn, and as such must
+ * remain valid until `term_run` has ended; it is never copied.
+ */
+void term_print_text(struct term_text *,
+                     struct term_position,
+                     struct term_color,
+                     struct term_bounds);
+
 /**
  * Fill a rectangular area with a color.
  *
@@ -190,8 +252,113 @@ void term_fill(struct term_position,
                struct term_dimens,
                struct term_color);
 
+/**
+ * Represents a retained list of print commands.
+ *
+ * A list can be recorded once and then printed any number of times, as long
+ * as its contents remain unchanged (e.g. a static border or HUD).
+ */
+struct term_list;
+
+/**
+ * Create an empty list.
+ */
+struct term_list * term_create_list(void);
+/**
+ * Release a list.
+ *
+ * A list must not be released between being printed and the end of
+ * `term_run`.
+ */
+void term_release_list(struct term_list *);
+
+/**
+ * Begin recording a list.
+ *
+ * Any print issued (e.g. `term_print`, `term_printstr` or `term_fill`) until
+ * recording has ended is not printed, but instead recorded into the list.
+ *
+ * Any previously recorded contents of the list are invalidated.
+ */
+void term_begin_list(struct term_list *);
+/**
+ * End recording the current list.
+ *
+ * All recorded prints are laid out as glyphs immediately, so pointed-to
+ * strings need only remain valid until this function returns.
+ */
+void term_end_list(void);
+
+/**
+ * Print a list.
+ *
+ * Each recorded glyph is printed at the position, layer, color and
+ * transformation that was in effect when it was recorded. Because glyphs
+ * have already been laid out, this is much cheaper than issuing each
+ * recorded print again.
+ *
+ * Like strings passed to `term_printstr`, the list must remain valid (not be
+ * invalidated, recorded or released) until `term_run` has ended.
+ */
+void term_print_list(struct term_list const *);
+
+/**
+ * Invalidate a list, clearing any recorded contents.
+ */
+void term_invalidate_list(struct term_list *);
+/**
+ * Determine whether a list holds valid recorded contents.
+ */
+bool term_is_list_valid(struct term_list const *);
+
+/**
+ * Represents a queue of print commands that can be filled from another thread.
+ *
+ * By default, every print goes into a single queue that is not thread safe.
+ * To print from several threads at once (e.g. during the draw callback), each
+ * thread must bind a queue of its own. Once the draw callback returns, the
+ * contents of every queue are merged and drawn along with everything else.
+ */
+struct term_queue;
+
+/**
+ * Create a queue.
+ *
+ * The order determines how prints in this queue are drawn relative to prints
+ * on the same layer in other queues: prints issued without a bound queue come
+ * first, followed by each queue in ascending order (queues of equal order
+ * follow the order they were created in). This way, the result remains the
+ * same no matter how threads happen to be scheduled.
+ *
+ * Queues must be created and released on the thread that opened the terminal,
+ * and never during the draw callback.
+ */
+struct term_queue * term_create_queue(uint32_t order);
+/**
+ * Release a queue.
+ */
+void term_release_queue(struct term_queue *);
+/**
+ * Bind a queue to the calling thread, or unbind it by passing NULL.
+ *
+ * While bound, every print issued from the calling thread goes into the queue.
+ * Each queue also holds its own glyph transformation, so setting one while
+ * a queue is bound only affects prints into that queue.
+ *
+ * A queue must only be bound to a single thread at a time, and all threads
+ * must be done printing before the draw callback returns. If the thread that
+ * opened the terminal binds a queue, it must also unbind it by then.
+ *
+ * Note that only printing (and counting) is thread safe; measuring strings, or
+ * recording lists, must still happen on the thread that opened the terminal.
+ */
+void term_bind_queue(struct term_queue *);
+
 /**
  * Count the number of printable characters in a string or set of characters.
+ *
+ * Counting does not depend on the terminal, and so can be done from any
+ * thread.
  */
 void term_count(char const * characters, size_t * amount);
 /**
@@ -211,6 +378,20 @@ void term_measure(char const * character,
 void term_measurestr(char const * text,
                      struct term_bounds,
                      struct term_dimens *);
+/**
+ * Measure the printed dimensions (in pixels) of a number of strings, each
+ * within its own bounds.
+ *
+ * This is equivalent to measuring each string by itself, but cheaper when
+ * measuring many strings at once; e.g. the labels of a menu.
+ *
+ * The resulting dimensions are scaled according to the currently set glyph
+ * transformation.
+ */
+void term_measurestrs(char const * const * texts,
+                      struct term_bounds const *,
+                      size_t count,
+                      struct term_dimens *);
 
 /**
  * Determine whether a key is currently held down.
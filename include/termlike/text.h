@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stddef.h> // size_t
+
+/**
+ * Represents an editable text.
+ *
+ * Unlike strings, which are decoded, wrapped and laid out every time they are
+ * printed (unless cached), a text keeps its characters decoded and wrapped
+ * between prints; each paragraph (i.e. anything between linebreaks) is kept
+ * separately, and only paragraphs affected by an edit are wrapped again.
+ *
+ * This makes texts suitable for content that changes a little at a time;
+ * e.g. the input line of a console, or the contents of a text editor.
+ *
+ * Positions within a text are always in characters, not bytes.
+ *
+ * The character limit of bounds (`term_bounds.limit`) does not apply to texts;
+ * a text is always laid out in full, and only cut off by the height of its
+ * bounds.
+ */
+struct term_text;
+
+/**
+ * Create an empty text.
+ */
+struct term_text * term_create_text(void);
+/**
+ * Release a text and all of its contents.
+ *
+ * A text must not be released until all prints of it have been drawn.
+ */
+void term_release_text(struct term_text *);
+
+/**
+ * Insert a string at a position in a text.
+ *
+ * If the position is past the end of the text, the string is appended.
+ */
+void term_text_insert(struct term_text *,
+                      size_t position,
+                      char const * characters);
+/**
+ * Erase a number of characters, beginning at a position in a text.
+ *
+ * Erasing past the end of the text only erases up to its end.
+ */
+void term_text_erase(struct term_text *,
+                     size_t position,
+                     size_t count);
+
+/**
+ * Return the number of characters in a text.
+ */
+size_t term_text_length(struct term_text const *);
@@ -0,0 +1,189 @@
+#include "arena.h" // arena, arena_*
+
+#include <stdlib.h> // malloc, free
+#include <stdint.h> // uint8_t
+#include <stddef.h> // size_t, NULL
+
+#include <string.h> // strlen, memcpy
+
+#ifdef DEBUG
+ #include <assert.h> // assert
+#endif
+
+/**
+ * The alignment (in bytes) of every block allocated from an arena.
+ */
+#define ARENA_ALIGNMENT (sizeof(void *) * 2)
+
+/**
+ * Represents a contiguous chunk of memory that blocks are allocated from.
+ *
+ * Chunks are never moved once allocated, so that allocated blocks remain valid.
+ */
+struct arena_chunk {
+    struct arena_chunk * previous;
+    size_t capacity;
+    size_t used;
+    // note that the memory of the chunk follows immediately after
+};
+
+struct arena {
+    /**
+     * The chunk that blocks are currently allocated from.
+     */
+    struct arena_chunk * chunk;
+    /**
+     * The number of bytes in use by all chunks.
+     */
+    size_t used;
+    /**
+     * The highest number of bytes ever in use.
+     */
+    size_t peak;
+};
+
+static struct arena_chunk * arena_chunk_init(struct arena_chunk * previous,
+                                             size_t capacity);
+static size_t arena_chunk_offset(void);
+
+struct arena *
+arena_init(size_t const capacity)
+{
+    struct arena * const arena = malloc(sizeof(struct arena));
+
+    arena->chunk = arena_chunk_init(NULL, capacity);
+
+    arena->used = 0;
+    arena->peak = 0;
+
+    return arena;
+}
+
+void
+arena_release(struct arena * const arena)
+{
+    struct arena_chunk * chunk = arena->chunk;
+
+    while (chunk != NULL) {
+        struct arena_chunk * const previous = chunk->previous;
+
+        free(chunk);
+
+        chunk = previous;
+    }
+
+    free(arena);
+}
+
+void *
+arena_alloc(struct arena * const arena, size_t const size)
+{
+    // round up so that the following block is aligned as well
+    size_t const aligned_size = (size + (ARENA_ALIGNMENT - 1)) &
+        ~(ARENA_ALIGNMENT - 1);
+
+    struct arena_chunk * chunk = arena->chunk;
+
+    if (chunk->used + aligned_size > chunk->capacity) {
+        // grow geometrically; at least doubling the total capacity
+        size_t capacity = chunk->capacity * 2;
+
+        if (capacity < aligned_size) {
+            capacity = aligned_size;
+        }
+
+        chunk = arena_chunk_init(chunk, capacity);
+
+        arena->chunk = chunk;
+    }
+
+    uint8_t * const memory = (uint8_t *)chunk + arena_chunk_offset();
+
+    void * const block = memory + chunk->used;
+
+    chunk->used += aligned_size;
+
+    arena->used += aligned_size;
+
+    if (arena->used > arena->peak) {
+        arena->peak = arena->used;
+    }
+
+    return block;
+}
+
+char const *
+arena_copy_str(struct arena * const arena, char const * const text)
+{
+#ifdef DEBUG
+    assert(text != NULL /* can't copy nothing */);
+#endif
+    size_t const size = strlen(text) + 1;
+
+    char * const copy = arena_alloc(arena, size);
+
+    memcpy(copy, text, size);
+
+    return copy;
+}
+
+void
+arena_reset(struct arena * const arena)
+{
+    struct arena_chunk * const chunk = arena->chunk;
+
+    if (chunk->previous != NULL) {
+        // the arena had to grow; replace all chunks by a single chunk that
+        // can hold everything, so that the next reset can simply rewind
+        size_t capacity = 0;
+
+        struct arena_chunk * previous = chunk;
+
+        while (previous != NULL) {
+            struct arena_chunk * const next = previous->previous;
+
+            capacity += previous->capacity;
+
+            free(previous);
+
+            previous = next;
+        }
+
+        arena->chunk = arena_chunk_init(NULL, capacity);
+    } else {
+        chunk->used = 0;
+    }
+
+    arena->used = 0;
+}
+
+void
+arena_get_usage(struct arena const * const arena,
+                size_t * const used,
+                size_t * const peak)
+{
+    *used = arena->used;
+    *peak = arena->peak;
+}
+
+static
+struct arena_chunk *
+arena_chunk_init(struct arena_chunk * const previous, size_t const capacity)
+{
+    struct arena_chunk * const chunk = malloc(arena_chunk_offset() + capacity);
+
+    chunk->previous = previous;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+
+    return chunk;
+}
+
+static
+size_t
+arena_chunk_offset(void)
+{
+    // memory begins after the chunk header, rounded up to be aligned
+    return (sizeof(struct arena_chunk) + (ARENA_ALIGNMENT - 1)) &
+        ~(ARENA_ALIGNMENT - 1);
+}
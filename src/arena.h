@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stddef.h> // size_t
+
+struct arena;
+
+/**
+ * Create an arena with an initial capacity (in bytes).
+ */
+struct arena * arena_init(size_t capacity);
+void arena_release(struct arena *);
+
+/**
+ * Allocate a block of memory from an arena.
+ *
+ * The block remains valid until the arena is reset. The arena grows as needed,
+ * but once it has grown to accomodate a full frame, it will not allocate again.
+ */
+void * arena_alloc(struct arena *, size_t size);
+/**
+ * Copy a null-terminated string into an arena.
+ */
+char const * arena_copy_str(struct arena *, char const *);
+
+/**
+ * Release all blocks allocated from an arena.
+ *
+ * Memory is retained, so that the arena can be reused without allocating.
+ */
+void arena_reset(struct arena *);
+
+/**
+ * Get the number of bytes currently in use, as well as the highest number of
+ * bytes that was ever in use at once (the high-water mark).
+ */
+void arena_get_usage(struct arena const *, size_t * used, size_t * peak);
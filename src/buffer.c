@@ -1,41 +1,83 @@
 #include "buffer.h" // buffer, buffer_*
 
-#include <stdlib.h> // malloc, free
-#include <stdint.h> // uint32_t, int32_t
-#include <stddef.h> // size_t
+#include <termlike/graphics/codepage.h> // codepage, codepage_index, CODEPAGE_*
+#include <termlike/bounds.h> // term_wrap, TERM_WRAP_*
 
-#include <string.h> // strlen, memset, memcpy
+#include <stdlib.h> // malloc, realloc, free
+#include <stdint.h> // uint8_t, uint32_t, int32_t
+#include <stddef.h> // size_t, NULL
+#include <stdbool.h> // bool
 
-#include <utf8.h> // utf8_decode
+#include <string.h> // strlen
+
+#include "decode.h" // decode_cp437
 
 #ifdef DEBUG
  #include <assert.h> // assert
 #endif
 
 /**
- * The size (in bytes) of a single UTF8 encoded character.
+ * The number of characters a buffer can initially hold.
+ */
+#define BUFFER_INITIAL_CAPACITY 256
+/**
+ * The number of lines a buffer can initially hold.
  */
-#define BUFFER_CHAR_SIZE (sizeof(uint32_t))
+#define BUFFER_INITIAL_LINE_CAPACITY 4
+
 /**
- * The size of the internal text buffer.
- *
- * This value must be at least 1 higher than the required amount of padding (4).
+ * Represents a line of characters in a buffer.
  */
-#define BUFFER_SIZE (MAX_TEXT_LENGTH * BUFFER_CHAR_SIZE)
+struct buffer_line {
+    /**
+     * The index of the first character on the line.
+     */
+    size_t start;
+    /**
+     * The number of characters on the line.
+     */
+    size_t count;
+};
+
+static void buffer_add_line(struct buffer *, size_t start, size_t end);
 
 struct buffer {
-    uint32_t decoded[BUFFER_SIZE];
+    /**
+     * The decoded characters, as glyph indices.
+     *
+     * Only the first `length` characters are valid; anything past that point
+     * is left over from previous copies.
+     */
+    uint8_t * decoded;
     char const * text;
+    size_t length;
+    /**
+     * The number of characters the buffer can hold.
+     *
+     * This grows to fit the longest string copied so far.
+     */
+    size_t capacity;
+    /**
+     * The lines that the decoded characters are broken into.
+     */
+    struct buffer_line * lines;
+    size_t line_count;
+    size_t line_capacity;
 };
 
-static void buffer_decode(struct buffer *, char * text, size_t length);
-
 struct buffer *
 buffer_init(void)
 {
     struct buffer * const buffer = malloc(sizeof(struct buffer));
 
-    memset(buffer->decoded, 0, sizeof(buffer->decoded));
+    buffer->text = NULL;
+    buffer->length = 0;
+    buffer->capacity = BUFFER_INITIAL_CAPACITY;
+    buffer->decoded = malloc(sizeof(uint8_t) * buffer->capacity);
+
+    buffer->line_count = 0;
+    buffer->line_capacity = BUFFER_INITIAL_LINE_CAPACITY;
+    buffer->lines = malloc(sizeof(struct buffer_line) * buffer->line_capacity);
 
     return buffer;
 }
@@ -43,137 +85,207 @@ buffer_init(void)
 void
 buffer_release(struct buffer * const buffer)
 {
+    free(buffer->decoded);
+    free(buffer->lines);
     free(buffer);
 }
 
 void
 buffer_copy(struct buffer * const buffer,
+            struct codepage const * const codepage,
             char const * const text,
             size_t const length)
 {
 #ifdef DEBUG
     assert(text != NULL /* can't copy nothing */);
 #endif
-    size_t size = strlen(text);
-#ifdef DEBUG
-    assert(size < MAX_TEXT_LENGTH /* size of text exceeds enforced limit */);
-#endif
+    size_t const size = strlen(text);
+
     buffer->text = text;
+    buffer->line_count = 0;
+
+    // a string never decodes into more characters than it has bytes
+    size_t const required = (length > 0 && length < size) ? length : size;
+
+    if (required > buffer->capacity) {
+        size_t expanded_capacity = buffer->capacity * 2;
+
+        while (expanded_capacity < required) {
+            expanded_capacity *= 2;
+        }
 
-    char content[BUFFER_SIZE];
+        // previously decoded content need not be kept, so there's no need
+        // to reallocate (which could end up copying it)
+        free(buffer->decoded);
 
-    // copy over entire string as-is
-    memcpy(&content, text, size);
-    // pad the buffer so that there's enough room to decode each character
-    memset(&content[size], '\0', BUFFER_CHAR_SIZE);
+        buffer->capacity = expanded_capacity;
+        buffer->decoded = malloc(sizeof(uint8_t) * buffer->capacity);
+    }
 
-    // clear any previously decoded content
-    // (but only clearing as much as we need to, e.g. not the entire buffer,
-    //  so "garbage" content may remain from previous copies- this shouldn't
-    //  matter as long as we pad the real content appropriately)
-    // note that we approximate the length to clear by treating
-    // each byte as 1 character; that isn't necesarilly correct,
-    // but in any case it will be better than clearing too little
-    size_t const n = (size * BUFFER_CHAR_SIZE) + BUFFER_CHAR_SIZE;
+    int32_t error = 0;
 
-    memset(buffer->decoded, 0, n);
+    // decode directly from the string; there's no need to clear, or pad,
+    // anything, as the decoder never reads past the end of the string, and
+    // the length of the decoded content is kept track of
+    buffer->length = decode_cp437(codepage, text, size,
+                                  buffer->decoded, required, &error);
+#ifdef DEBUG
+    assert(error == 0 /* see utf8.h for error description */);
+#endif
+}
 
-    buffer_decode(buffer, content, length);
+void
+buffer_clear(struct buffer * const buffer)
+{
+    buffer->text = NULL;
+    buffer->length = 0;
+    buffer->line_count = 0;
 }
 
 void
-buffer_wrap(struct buffer * const buffer, size_t const limit)
+buffer_append(struct buffer * const buffer,
+              struct codepage const * const codepage,
+              uint32_t const * const codepoints,
+              size_t const count)
 {
-    size_t num_characters = 0;
+    size_t const required = buffer->length + count;
 
-    uint32_t character = 0;
+    if (required > buffer->capacity) {
+        while (buffer->capacity < required) {
+            buffer->capacity *= 2;
+        }
 
-    uint32_t * const start = buffer->decoded;
-    uint32_t * next = start;
+        // previously decoded content must be kept here
+        buffer->decoded = realloc(buffer->decoded,
+                                  sizeof(uint8_t) * buffer->capacity);
+    }
 
-    while (*next) {
-        character = *next;
+    uint8_t * const indices = &buffer->decoded[buffer->length];
 
-        uint32_t * previous = next;
+    for (size_t i = 0; i < count; i++) {
+        indices[i] = codepage_index(codepage, codepoints[i]);
+    }
 
-        // pointer arithmetic; automatically scales by sizeof uint32_t
-        next++;
+    buffer->length = required;
+    buffer->line_count = 0;
+}
 
-        num_characters += 1;
+void
+buffer_wrap(struct buffer * const buffer,
+            size_t const limit,
+            enum term_wrap const wrap)
+{
+    uint8_t const * const decoded = buffer->decoded;
 
-        if (character == '\n') {
-            // we hit an explicit linebreak,
-            // so we can assume that a new line starts here
-            num_characters = 0;
-        }
+    buffer->line_count = 0;
+
+    // the start of the current line, and the last whitespace on it (if any);
+    // whitespace is only kept track of when wrapping on words
+    size_t start = 0;
+    size_t space = 0;
+
+    bool has_space = false;
+
+    for (size_t i = 0; i < buffer->length; i++) {
+        uint8_t const index = decoded[i];
+
+        if (index == CODEPAGE_LINEBREAK) {
+            // we hit an explicit linebreak, so a new line starts after it
+            buffer_add_line(buffer, start, i);
+
+            start = i + 1;
+            has_space = false;
 
-        if (num_characters <= limit) {
-            // we've not yet reached the limit for number of characters per line
-            // so we just continue with reading the next character
             continue;
         }
 
-        // we've reached the limit for number of characters per line,
-        // so backtrack to find a previous whitespace where we can break
-        // note that in a case where no available whitespace can be found,
-        // no breaks will be inserted
-        while (previous != start) {
-            if (*previous == ' ') {
-                *previous = '\n';
-
-                // make sure to begin the next line from this point
-                // we can be sure that this is not "mid-character" for
-                // larger-sized characters, because we specifically found
-                // the whitespace
-                next = previous;
-
-                break;
+        if (limit > 0 && i - start == limit) {
+            // this character does not fit on the current line
+            if (wrap == TERM_WRAP_WORDS && index == CODEPAGE_SPACE) {
+                // break at this whitespace, leaving it out
+                buffer_add_line(buffer, start, i);
+
+                start = i + 1;
+                has_space = false;
+
+                continue;
             }
 
-            // pointer arithmetic; automatically scales by sizeof uint32_t
-            previous--;
+            if (has_space) {
+                // break at the last whitespace, leaving it out; what remains
+                // after it always fits on the next line
+                buffer_add_line(buffer, start, space);
+
+                start = space + 1;
+                has_space = false;
+            } else {
+                // no whitespace to break at (or wrapping on characters),
+                // so break right before this character
+                buffer_add_line(buffer, start, i);
+
+                start = i;
+            }
+        }
+
+        if (wrap == TERM_WRAP_WORDS && index == CODEPAGE_SPACE) {
+            space = i;
+            has_space = true;
         }
     }
+
+    // there's always at least one line, even if empty
+    buffer_add_line(buffer, start, buffer->length);
 }
 
-void
-buffer_foreach(struct buffer const * const buffer,
-               buffer_callback * const callback,
-               void * const state)
+size_t
+buffer_line_count(struct buffer const * const buffer)
 {
-    uint16_t i = 0;
-    uint32_t glyph = buffer->decoded[i];
+    return buffer->line_count;
+}
 
-    while (glyph != 0) {
-        callback(glyph, state);
+size_t
+buffer_widest_line(struct buffer const * const buffer)
+{
+    size_t widest = 0;
 
-        i += 1;
+    for (size_t i = 0; i < buffer->line_count; i++) {
+        if (buffer->lines[i].count > widest) {
+            widest = buffer->lines[i].count;
+        }
+    }
+
+    return widest;
+}
+
+void
+buffer_foreach_line(struct buffer const * const buffer,
+                    buffer_line_callback * const callback,
+                    void * const state)
+{
+    for (size_t i = 0; i < buffer->line_count; i++) {
+        struct buffer_line const line = buffer->lines[i];
 
-        glyph = buffer->decoded[i];
+        callback(&buffer->decoded[line.start], line.count, (uint32_t)i, state);
     }
 }
 
 static
 void
-buffer_decode(struct buffer * const buffer,
-              char * const text,
-              size_t const length)
+buffer_add_line(struct buffer * const buffer,
+                size_t const start,
+                size_t const end)
 {
-    int32_t error = 0;
-    size_t i = 0;
+    if (buffer->line_count == buffer->line_capacity) {
+        buffer->line_capacity *= 2;
+        buffer->lines = realloc(buffer->lines,
+                                sizeof(struct buffer_line) *
+                                buffer->line_capacity);
+    }
 
-    char * next = text;
+    buffer->lines[buffer->line_count] = (struct buffer_line) {
+        .start = start,
+        .count = end - start
+    };
 
-    while (*next) {
-        // decode and advance the text pointer
-        next = utf8_decode(next, &buffer->decoded[i], &error);
-#ifdef DEBUG
-        assert(error == 0 /* see utf8.h for error description */);
-#endif
-        i += 1;
-
-        if (i == length) {
-            break;
-        }
-    }
+    buffer->line_count += 1;
 }
@@ -1,19 +1,26 @@
 #pragma once
 
-#include <stdint.h> // uint32_t
-#include <stddef.h> // size_t
+#include <termlike/bounds.h> // term_wrap
 
-/**
- * The maximum number of characters a buffer will hold.
- */
-#define MAX_TEXT_LENGTH (4096)
+#include <stdint.h> // uint8_t
+#include <stddef.h> // size_t
 
 struct buffer;
+struct codepage;
 
 /**
- * Represents a function invoked for each printable character in a buffer.
+ * Represents a function invoked for each line in a buffer.
+ *
+ * Each line is passed as the glyph indices of its characters, along with
+ * the number of characters on the line and the number of the line.
+ *
+ * The characters never include the linebreak (or whitespace) that ended the
+ * line.
  */
-typedef void buffer_callback(uint32_t character, void *);
+typedef void buffer_line_callback(uint8_t const * indices,
+                                  size_t count,
+                                  uint32_t line,
+                                  void *);
 
 struct buffer * buffer_init(void);
 void buffer_release(struct buffer *);
@@ -21,23 +28,59 @@ void buffer_release(struct buffer *);
 /**
  * Copy a string to a buffer, preparing it for printing.
  *
+ * The string is decoded into indices of glyphs in a codepage; i.e. characters
+ * are mapped to glyphs once, when copied, rather than every time they are
+ * drawn.
+ *
  * If length is not zero, only characters up to that point is copied. Otherwise
  * entire string is copied (null-terminated).
  */
-void buffer_copy(struct buffer *, char const *, size_t length);
+void buffer_copy(struct buffer *,
+                 struct codepage const *,
+                 char const *,
+                 size_t length);
+/**
+ * Clear the text contents of a buffer.
+ */
+void buffer_clear(struct buffer *);
 /**
- * Apply word-wrapping to the text contents of a buffer.
+ * Append codepoints to the text contents of a buffer.
  *
- * This function alters the contents of the buffer by replacing whitespaces
- * with linebreaks in cases where wrapping is required.
+ * Each codepoint is mapped to the index of its glyph in a codepage, just as
+ * when copying a string. Linebreaks are not expected, and are mapped like any
+ * other character.
  */
-void buffer_wrap(struct buffer *, size_t limit);
+void buffer_append(struct buffer *,
+                   struct codepage const *,
+                   uint32_t const * codepoints,
+                   size_t count);
+/**
+ * Break the text contents of a buffer into lines.
+ *
+ * Lines always end at linebreaks. If limit is not zero, lines also end before
+ * exceeding that number of characters; when wrapping on words, at the last
+ * whitespace (which is then left out), or anywhere for words that are too
+ * long to fit on a line by themselves.
+ *
+ * The contents of the buffer are not altered; lines are kept as spans on the
+ * side, and remain valid until the next copy.
+ */
+void buffer_wrap(struct buffer *, size_t limit, enum term_wrap);
+/**
+ * Return the number of lines in a buffer.
+ */
+size_t buffer_line_count(struct buffer const *);
+/**
+ * Return the number of characters on the longest line in a buffer.
+ */
+size_t buffer_widest_line(struct buffer const *);
 
 /**
- * Run through all printable characters in a buffer and issue a
- * callback for each.
+ * Run through all lines in a buffer and issue a callback for each.
+ *
+ * Lines must have been determined by wrapping the buffer first.
  *
  * Functions that require stateful callbacks can provide a generic void pointer
  * that will be passed along with each issued callback.
  */
-void buffer_foreach(struct buffer const *, buffer_callback *, void *);
+void buffer_foreach_line(struct buffer const *, buffer_line_callback *, void *);
@@ -0,0 +1,361 @@
+#include "cache.h" // layout_cache, cache_*
+#include "layout.h" // layout, layout_*
+
+#include <termlike/bounds.h> // term_bounds
+#include <termlike/transform.h> // term_scale
+
+#include <stdlib.h> // malloc, calloc, realloc, free
+#include <stdint.h> // uint16_t, uint32_t, uint64_t, UINT32_MAX
+#include <stddef.h> // size_t, NULL
+#include <stdbool.h> // bool
+
+#include <string.h> // memcmp, memcpy
+
+/**
+ * Represents the absence of an entry.
+ */
+#define CACHE_NONE UINT32_MAX
+
+/**
+ * The offset basis of the FNV-1a hash function.
+ */
+#define HASH_OFFSET 0xcbf29ce484222325ULL
+/**
+ * The prime of the FNV-1a hash function.
+ */
+#define HASH_PRIME 0x100000001b3ULL
+
+/**
+ * Represents everything that the layout of a string depends on.
+ */
+struct cache_key {
+    struct term_bounds bounds;
+    struct term_scale scale;
+    uint64_t hash;
+    uint16_t glyph_size;
+    size_t length;
+};
+
+struct cache_entry {
+    struct cache_key key;
+    struct layout layout;
+    /**
+     * A copy of the string that was laid out.
+     *
+     * This is compared on lookup, to rule out any hash collisions.
+     */
+    char * text;
+    size_t text_capacity;
+    /**
+     * The next entry in the same hash bucket.
+     */
+    uint32_t chained;
+    /**
+     * The previous (more recently used) entry.
+     */
+    uint32_t previous;
+    /**
+     * The next (less recently used) entry.
+     */
+    uint32_t next;
+};
+
+struct layout_cache {
+    struct cache_entry * entries;
+    /**
+     * The first entry in each hash bucket.
+     */
+    uint32_t * buckets;
+    size_t bucket_count;
+    size_t capacity;
+    size_t count;
+    /**
+     * The most recently used entry.
+     */
+    uint32_t head;
+    /**
+     * The least recently used entry.
+     */
+    uint32_t tail;
+    size_t hits;
+    size_t misses;
+};
+
+static uint64_t cache_hash(char const * text,
+                           struct term_bounds,
+                           struct term_scale,
+                           uint16_t glyph_size,
+                           size_t * length);
+static uint64_t cache_hash_bytes(uint64_t hash, void const * data, size_t size);
+
+static bool cache_key_equals(struct cache_key const *,
+                             struct cache_key const *);
+
+static void cache_unlink(struct layout_cache *, uint32_t entry);
+static void cache_link(struct layout_cache *, uint32_t entry);
+static void cache_unchain(struct layout_cache *, uint32_t entry);
+
+struct layout_cache *
+cache_init(size_t const capacity)
+{
+    struct layout_cache * const cache = malloc(sizeof(struct layout_cache));
+
+    cache->capacity = capacity;
+    cache->count = 0;
+
+    // keep at most 50% load on buckets
+    cache->bucket_count = 1;
+
+    while (cache->bucket_count < capacity * 2) {
+        cache->bucket_count *= 2;
+    }
+
+    cache->entries = malloc(sizeof(struct cache_entry) * capacity);
+    cache->buckets = malloc(sizeof(uint32_t) * cache->bucket_count);
+
+    for (size_t i = 0; i < cache->bucket_count; i++) {
+        cache->buckets[i] = CACHE_NONE;
+    }
+
+    cache->head = CACHE_NONE;
+    cache->tail = CACHE_NONE;
+
+    cache->hits = 0;
+    cache->misses = 0;
+
+    return cache;
+}
+
+void
+cache_release(struct layout_cache * const cache)
+{
+    for (size_t i = 0; i < cache->count; i++) {
+        struct cache_entry * const entry = &cache->entries[i];
+
+        layout_release(&entry->layout);
+
+        free(entry->text);
+    }
+
+    free(cache->entries);
+    free(cache->buckets);
+    free(cache);
+}
+
+struct layout *
+cache_get(struct layout_cache * const cache,
+          char const * const text,
+          struct term_bounds const bounds,
+          struct term_scale const scale,
+          uint16_t const glyph_size,
+          bool * const hit)
+{
+    struct cache_key key = {
+        .bounds = bounds,
+        .scale = scale,
+        .glyph_size = glyph_size
+    };
+
+    key.hash = cache_hash(text, bounds, scale, glyph_size, &key.length);
+
+    size_t const bucket = key.hash & (cache->bucket_count - 1);
+
+    uint32_t index = cache->buckets[bucket];
+
+    while (index != CACHE_NONE) {
+        struct cache_entry * const entry = &cache->entries[index];
+
+        if (cache_key_equals(&entry->key, &key) &&
+            memcmp(entry->text, text, key.length) == 0) {
+            // move to front, as this is now the most recently used entry
+            cache_unlink(cache, index);
+            cache_link(cache, index);
+
+            cache->hits += 1;
+
+            *hit = true;
+
+            return &entry->layout;
+        }
+
+        index = entry->chained;
+    }
+
+    cache->misses += 1;
+
+    if (cache->count < cache->capacity) {
+        index = (uint32_t)cache->count;
+
+        struct cache_entry * const entry = &cache->entries[index];
+
+        layout_init(&entry->layout);
+
+        entry->text_capacity = 0;
+        entry->text = NULL;
+
+        cache->count += 1;
+    } else {
+        // evict the least recently used entry
+        index = cache->tail;
+
+        cache_unlink(cache, index);
+        cache_unchain(cache, index);
+    }
+
+    struct cache_entry * const entry = &cache->entries[index];
+
+    if (entry->text == NULL || entry->text_capacity < key.length) {
+        entry->text_capacity = key.length + 1;
+        entry->text = realloc(entry->text, entry->text_capacity);
+    }
+
+    memcpy(entry->text, text, key.length);
+
+    entry->key = key;
+
+    layout_clear(&entry->layout);
+
+    entry->chained = cache->buckets[bucket];
+    cache->buckets[bucket] = index;
+
+    cache_link(cache, index);
+
+    *hit = false;
+
+    return &entry->layout;
+}
+
+void
+cache_get_stats(struct layout_cache const * const cache,
+                size_t * const hits,
+                size_t * const misses)
+{
+    *hits = cache->hits;
+    *misses = cache->misses;
+}
+
+void
+cache_reset_stats(struct layout_cache * const cache)
+{
+    cache->hits = 0;
+    cache->misses = 0;
+}
+
+static
+uint64_t
+cache_hash(char const * const text,
+           struct term_bounds const bounds,
+           struct term_scale const scale,
+           uint16_t const glyph_size,
+           size_t * const length)
+{
+    uint64_t hash = HASH_OFFSET;
+
+    char const * next = text;
+
+    while (*next) {
+        hash ^= (uint8_t)*next;
+        hash *= HASH_PRIME;
+
+        next++;
+    }
+
+    *length = (size_t)(next - text);
+
+    // fold in each field separately; the structs may hold padding
+    hash = cache_hash_bytes(hash, &bounds.size, sizeof(bounds.size));
+    hash = cache_hash_bytes(hash, &bounds.wrap, sizeof(bounds.wrap));
+    hash = cache_hash_bytes(hash, &bounds.align, sizeof(bounds.align));
+    hash = cache_hash_bytes(hash, &bounds.limit, sizeof(bounds.limit));
+    hash = cache_hash_bytes(hash, &scale, sizeof(scale));
+    hash = cache_hash_bytes(hash, &glyph_size, sizeof(glyph_size));
+
+    return hash;
+}
+
+static
+uint64_t
+cache_hash_bytes(uint64_t hash,
+                 void const * const data,
+                 size_t const size)
+{
+    uint8_t const * const bytes = (uint8_t const *)data;
+
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= HASH_PRIME;
+    }
+
+    return hash;
+}
+
+static
+bool
+cache_key_equals(struct cache_key const * const key,
+                 struct cache_key const * const other_key)
+{
+    return (key->hash == other_key->hash &&
+            key->length == other_key->length &&
+            key->bounds.size.width == other_key->bounds.size.width &&
+            key->bounds.size.height == other_key->bounds.size.height &&
+            key->bounds.wrap == other_key->bounds.wrap &&
+            key->bounds.align == other_key->bounds.align &&
+            key->bounds.limit == other_key->bounds.limit &&
+            key->glyph_size == other_key->glyph_size &&
+            memcmp(&key->scale, &other_key->scale,
+                   sizeof(struct term_scale)) == 0);
+}
+
+static
+void
+cache_unlink(struct layout_cache * const cache, uint32_t const index)
+{
+    struct cache_entry * const entry = &cache->entries[index];
+
+    if (entry->previous != CACHE_NONE) {
+        cache->entries[entry->previous].next = entry->next;
+    } else {
+        cache->head = entry->next;
+    }
+
+    if (entry->next != CACHE_NONE) {
+        cache->entries[entry->next].previous = entry->previous;
+    } else {
+        cache->tail = entry->previous;
+    }
+}
+
+static
+void
+cache_link(struct layout_cache * const cache, uint32_t const index)
+{
+    struct cache_entry * const entry = &cache->entries[index];
+
+    entry->previous = CACHE_NONE;
+    entry->next = cache->head;
+
+    if (cache->head != CACHE_NONE) {
+        cache->entries[cache->head].previous = index;
+    } else {
+        cache->tail = index;
+    }
+
+    cache->head = index;
+}
+
+static
+void
+cache_unchain(struct layout_cache * const cache, uint32_t const index)
+{
+    struct cache_entry * const entry = &cache->entries[index];
+
+    size_t const bucket = entry->key.hash & (cache->bucket_count - 1);
+
+    uint32_t * link = &cache->buckets[bucket];
+
+    while (*link != index) {
+        link = &cache->entries[*link].chained;
+    }
+
+    *link = entry->chained;
+}
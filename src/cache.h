@@ -0,0 +1,45 @@
+#pragma once
+
+#include <termlike/bounds.h> // term_bounds :completeness
+#include <termlike/transform.h> // term_scale :completeness
+
+#include <stddef.h> // size_t
+#include <stdint.h> // uint16_t
+#include <stdbool.h> // bool
+
+struct layout;
+
+struct layout_cache;
+
+/**
+ * Create a cache holding, at most, a number of laid out strings.
+ *
+ * Once full, the least recently used layout is evicted to make room for
+ * a new one.
+ */
+struct layout_cache * cache_init(size_t capacity);
+void cache_release(struct layout_cache *);
+
+/**
+ * Return the layout of a string within bounds and at a scale, using glyphs
+ * of a size (in pixels).
+ *
+ * If the layout is not already cached, a cleared layout is returned instead,
+ * and it is left to the caller to lay out the string (see `layout_*`).
+ *
+ * The returned layout remains valid until the next call to this function.
+ */
+struct layout * cache_get(struct layout_cache *,
+                          char const * text,
+                          struct term_bounds,
+                          struct term_scale,
+                          uint16_t glyph_size,
+                          bool * hit);
+
+/**
+ * Get the number of hits and misses since the last reset.
+ */
+void cache_get_stats(struct layout_cache const *,
+                     size_t * hits,
+                     size_t * misses);
+void cache_reset_stats(struct layout_cache *);
@@ -0,0 +1,10 @@
+#include <termlike/cell.h> // term_cell, term_grid, indexed, gridded
+
+#include <stdint.h> // uint8_t, uint32_t
+#include <stddef.h> // size_t
+
+extern inline uint32_t indexed(uint8_t index);
+extern inline struct term_grid gridded(struct term_cell const * cells,
+                                       size_t count,
+                                       size_t columns,
+                                       struct term_dimens pitch);
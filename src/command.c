@@ -1,60 +1,208 @@
 #include "command.h" // command, command_index, command_*
+#include "arena.h" // arena, arena_*
+#include "intern.h" // intern_table, intern_*
 
 #include <termlike/layer.h> // term_layer
 
 #include <stdlib.h> // malloc, free, qsort
-#include <stdint.h> // uint16_t, uint32_t, UINT8_MAX, UINT16_MAX
+#include <stdint.h> // uint16_t, uint32_t, uint64_t, UINT8_MAX, UINT16_MAX, UINT32_MAX
 #include <stddef.h> // size_t, NULL
+#include <string.h> // memset, memcpy, memmove
 
 #ifdef DEBUG
  #include <assert.h> // assert
 #endif
 
-#ifdef _WIN32
- #include <string.h> // memcpy
+/**
+ * The initial capacity (in bytes) of the arena holding transient data.
+ */
+#define ARENA_CAPACITY (16 * 1024)
+
+#ifdef TERM_USE_COMMAND_BUCKETS
+ // commands are kept in order as they are pushed; no sorting needed
+ #undef TERM_USE_RADIX_SORT
+/**
+ * The initial number of distinct depths that buckets are held for.
+ */
+ #define BUCKET_CAPACITY 16
+#endif
+
+#ifdef TERM_USE_RADIX_SORT
+/**
+ * The number of bits sorted per radix pass.
+ */
+ #define RADIX_BITS 8
+/**
+ * The number of buckets per radix pass.
+ */
+ #define RADIX_SIZE (1 << RADIX_BITS)
+/**
+ * The number of passes required to sort the depth of a command index.
+ *
+ * Call order need not be sorted, as commands are pushed in call order to
+ * begin with and the sort is stable.
+ */
+ #define RADIX_PASSES (sizeof(uint16_t) * 8 / RADIX_BITS)
 #endif
 
-#define MAX_CAPACITY UINT16_MAX
+/**
+ * The number of bits that the depth of a command index is shifted by.
+ */
+#define INDEX_DEPTH_SHIFT 32
 
 struct command_index {
-    // note that the order of fields is important
-    // going from top to bottom, top is least significant and bottom is most
+    // note that when packed, the order is the least significant part and the
+    // depth is the most significant part (see `command_index_to_int`)
     // this effectively means Z-value is more important than call order
     // but two indices with identical Z-value will fall back to call order
-    uint16_t order;
+    uint32_t order;
+    uint16_t depth;
+};
+
+#ifdef TERM_USE_RADIX_SORT
+/**
+ * Represents the sort key of a command.
+ *
+ * Keys are sorted instead of commands, as they are much smaller to move around.
+ */
+struct command_key {
+    /**
+     * The depth of the command (see `command_index`).
+     */
+    uint32_t depth;
+    /**
+     * The position of the command in the buffer.
+     */
+    uint32_t slot;
+};
+#endif
+
+#ifdef TERM_USE_COMMAND_BUCKETS
+/**
+ * Represents all commands pushed at a specific depth, in call order.
+ */
+struct command_bucket {
+    /**
+     * The positions of commands in the buffer.
+     */
+    uint32_t * slots;
+    size_t capacity;
+    size_t count;
     uint16_t depth;
 };
 
+/**
+ * Represents the set of buckets holding commands during a frame.
+ *
+ * Only depths that have been pushed to are held, rather than a bucket for
+ * every possible depth, as most buffers (e.g. lists and queues) only ever
+ * use a handful of depths.
+ */
+struct command_buckets {
+    /**
+     * The buckets of every depth pushed to so far, in ascending order.
+     *
+     * Buckets are kept (but emptied) when flushed, so that they can be
+     * reused in subsequent frames.
+     */
+    struct command_bucket * list;
+    size_t capacity;
+    size_t count;
+    /**
+     * The position of the bucket last pushed to.
+     *
+     * Consecutive commands are commonly pushed at the same depth.
+     */
+    size_t last;
+};
+#endif
+
 struct command_buffer {
     struct command * commands;
+    /**
+     * An arena holding transient data for the current frame.
+     *
+     * The arena is only created when first needed.
+     */
+    struct arena * arena;
+    /**
+     * The distinct transformations referred to by commands.
+     */
+    struct intern_table * transforms;
+    /**
+     * The distinct bounds referred to by commands.
+     */
+    struct intern_table * bounds;
+#ifdef TERM_USE_COMMAND_BUCKETS
+    struct command_buckets buckets;
+#endif
+#ifdef TERM_USE_RADIX_SORT
+    struct command_key * keys;
+    struct command_key * sorted_keys;
+#endif
     size_t capacity;
     size_t count;
 };
 
-static inline struct command_index command_int_to_index(uint32_t index);
-static inline uint32_t command_index_to_int(struct command_index);
+static inline struct command_index command_int_to_index(uint64_t index);
+static inline struct command_attributes
+    command_get_attributes(struct command_buffer const *,
+                           struct command const *);
+static inline uint64_t command_index_to_int(struct command_index);
+#if defined(TERM_USE_COMMAND_BUCKETS)
+static void command_bucket_push(struct command_buckets *,
+                                uint16_t depth,
+                                uint32_t slot);
+static void command_bucket_release(struct command_buckets *);
+#elif defined(TERM_USE_RADIX_SORT)
+static struct command_key const * command_sort(struct command_buffer *);
+#else
 static int32_t command_compare(void const *, void const *);
+#endif
 
 struct command_buffer *
 command_init(void)
 {
-#ifdef DEBUG
-    assert(sizeof(struct command_index) == sizeof(uint32_t));
-#endif
-
     struct command_buffer * const buf = malloc(sizeof(struct command_buffer));
 
     buf->count = 0;
     buf->capacity = UINT8_MAX + 1;
 
     buf->commands = malloc(sizeof(struct command) * buf->capacity);
-
+    buf->arena = NULL;
+    buf->transforms = intern_init(sizeof(struct term_transform));
+    buf->bounds = intern_init(sizeof(struct term_bounds));
+#ifdef TERM_USE_COMMAND_BUCKETS
+    buf->buckets.count = 0;
+    buf->buckets.last = 0;
+    buf->buckets.capacity = BUCKET_CAPACITY;
+    buf->buckets.list = malloc(sizeof(struct command_bucket) *
+                               buf->buckets.capacity);
+#endif
+#ifdef TERM_USE_RADIX_SORT
+    buf->keys = malloc(sizeof(struct command_key) * buf->capacity);
+    buf->sorted_keys = malloc(sizeof(struct command_key) * buf->capacity);
+#endif
     return buf;
 }
 
 void
 command_release(struct command_buffer * const buffer)
 {
+#ifdef TERM_USE_COMMAND_BUCKETS
+    command_bucket_release(&buffer->buckets);
+#endif
+#ifdef TERM_USE_RADIX_SORT
+    free(buffer->keys);
+    free(buffer->sorted_keys);
+#endif
+    if (buffer->arena != NULL) {
+        arena_release(buffer->arena);
+    }
+
+    intern_release(buffer->transforms);
+    intern_release(buffer->bounds);
+
     free(buffer->commands);
     free(buffer);
 }
@@ -66,7 +214,20 @@ command_get_capacity(struct command_buffer const * const buffer,
                      size_t * const cap)
 {
     *used = sizeof(struct command) * buffer->count;
-    *cap = sizeof(struct command) * MAX_CAPACITY;
+    *cap = sizeof(struct command) * buffer->capacity;
+}
+
+void
+command_get_arena_usage(struct command_buffer const * const buffer,
+                        size_t * const used,
+                        size_t * const peak)
+{
+    *used = 0;
+    *peak = 0;
+
+    if (buffer->arena != NULL) {
+        arena_get_usage(buffer->arena, used, peak);
+    }
 }
 #endif
 
@@ -77,8 +238,9 @@ command_push(struct command_buffer * const buffer,
     if (buffer->capacity == buffer->count) {
         size_t expanded_capacity = buffer->capacity * 2;
 
-        if (expanded_capacity > MAX_CAPACITY) {
-            expanded_capacity = MAX_CAPACITY;
+        if (expanded_capacity > UINT32_MAX) {
+            // each command must be addressable by its order (and slot)
+            expanded_capacity = UINT32_MAX;
         }
 
 #ifdef DEBUG
@@ -88,6 +250,12 @@ command_push(struct command_buffer * const buffer,
         buffer->capacity = expanded_capacity;
         buffer->commands = realloc(buffer->commands,
                                    sizeof(struct command) * buffer->capacity);
+#ifdef TERM_USE_RADIX_SORT
+        buffer->keys = realloc(buffer->keys,
+                               sizeof(struct command_key) * buffer->capacity);
+        buffer->sorted_keys = realloc(buffer->sorted_keys,
+                                      sizeof(struct command_key) * buffer->capacity);
+#endif
     }
 
 #ifdef _WIN32
@@ -96,14 +264,88 @@ command_push(struct command_buffer * const buffer,
     buffer->commands[buffer->count] = command;
 #endif
 
+#ifdef TERM_USE_COMMAND_BUCKETS
+    command_bucket_push(&buffer->buckets,
+                        command_int_to_index(command.index).depth,
+                        (uint32_t)buffer->count);
+#endif
+#ifdef TERM_USE_RADIX_SORT
+    buffer->keys[buffer->count] = (struct command_key) {
+        .depth = command_int_to_index(command.index).depth,
+        .slot = (uint32_t)buffer->count
+    };
+#endif
+
     buffer->count += 1;
 }
 
+void *
+command_alloc(struct command_buffer * const buffer, size_t const size)
+{
+    if (buffer->arena == NULL) {
+        buffer->arena = arena_init(ARENA_CAPACITY);
+    }
+
+    return arena_alloc(buffer->arena, size);
+}
+
+char const *
+command_copy_str(struct command_buffer * const buffer,
+                 char const * const text)
+{
+    if (buffer->arena == NULL) {
+        buffer->arena = arena_init(ARENA_CAPACITY);
+    }
+
+    return arena_copy_str(buffer->arena, text);
+}
+
+uint32_t
+command_intern_transform(struct command_buffer * const buffer,
+                         struct term_transform const * const transform)
+{
+    return intern_add(buffer->transforms, transform);
+}
+
+uint32_t
+command_intern_bounds(struct command_buffer * const buffer,
+                      struct term_bounds const * const bounds)
+{
+    return intern_add(buffer->bounds, bounds);
+}
+
 void
 command_flush(struct command_buffer * const buffer,
-              command_callback * const callback)
+              command_callback * const callback,
+              void * const state)
 {
     if (callback != NULL) {
+#if defined(TERM_USE_COMMAND_BUCKETS)
+        struct command_buckets * const buckets = &buffer->buckets;
+
+        for (size_t i = 0; i < buckets->count; i++) {
+            struct command_bucket const * const bucket = &buckets->list[i];
+
+            for (size_t j = 0; j < bucket->count; j++) {
+                struct command * const command =
+                    &buffer->commands[bucket->slots[j]];
+
+                callback(command,
+                         command_get_attributes(buffer, command),
+                         state);
+            }
+        }
+#elif defined(TERM_USE_RADIX_SORT)
+        struct command_key const * const keys = command_sort(buffer);
+
+        for (size_t i = 0; i < buffer->count; i++) {
+            struct command * const command = &buffer->commands[keys[i].slot];
+
+            callback(command,
+                     command_get_attributes(buffer, command),
+                     state);
+        }
+#else
         qsort(buffer->commands,
               buffer->count,
               sizeof(struct command),
@@ -112,25 +354,85 @@ command_flush(struct command_buffer * const buffer,
         for (size_t i = 0; i < buffer->count; i++) {
             struct command * const command = &buffer->commands[i];
 
-            callback(command);
+            callback(command,
+                     command_get_attributes(buffer, command),
+                     state);
         }
+#endif
     }
 
+#ifdef TERM_USE_COMMAND_BUCKETS
+    struct command_buckets * const buckets = &buffer->buckets;
+
+    for (size_t i = 0; i < buckets->count; i++) {
+        buckets->list[i].count = 0;
+    }
+#endif
+
+    if (buffer->arena != NULL) {
+        arena_reset(buffer->arena);
+    }
+
+    intern_reset(buffer->transforms);
+    intern_reset(buffer->bounds);
+
     buffer->count = 0;
 }
 
-uint32_t
+void
+command_merge(struct command_buffer * const buffer,
+              struct command_buffer const * const other)
+{
+#ifdef DEBUG
+    assert(buffer != other /* can't merge buffer into itself */);
+#endif
+    // commands are merged in the order they were pushed, not the order they
+    // would be flushed in; this way, the order of commands at the same depth
+    // is kept, and sorting is deferred to flushing the receiving buffer
+    for (size_t i = 0; i < other->count; i++) {
+        struct command command = other->commands[i];
+
+        command.index = command_next_depth_index(buffer, command.index);
+        // ids are only meaningful to the buffer that interned them
+        command.transform = intern_add(buffer->transforms,
+                                       intern_get(other->transforms,
+                                                  command.transform));
+        command.bounds = intern_add(buffer->bounds,
+                                    intern_get(other->bounds,
+                                               command.bounds));
+
+        command_push(buffer, command);
+    }
+}
+
+uint64_t
 command_next_layered_index(struct command_buffer const * const buffer,
                            struct term_layer const layer)
 {
+#ifdef DEBUG
+    assert(buffer->count < UINT32_MAX /* order would wrap around */);
+#endif
     return command_index_to_int((struct command_index) {
-        .order = (uint16_t)buffer->count,
+        .order = (uint32_t)buffer->count,
         .depth = (layer.index * UINT8_MAX) + layer.depth
     });
 }
 
+uint64_t
+command_next_depth_index(struct command_buffer const * const buffer,
+                         uint64_t const index)
+{
+#ifdef DEBUG
+    assert(buffer->count < UINT32_MAX /* order would wrap around */);
+#endif
+    return command_index_to_int((struct command_index) {
+        .order = (uint32_t)buffer->count,
+        .depth = command_int_to_index(index).depth
+    });
+}
+
 float
-command_index_to_z(uint32_t const index)
+command_index_to_z(uint64_t const index)
 {
     struct command_index const cmd_index = command_int_to_index(index);
 
@@ -139,22 +441,198 @@ command_index_to_z(uint32_t const index)
 
 static inline
 struct command_index
-command_int_to_index(uint32_t const index)
+command_int_to_index(uint64_t const index)
 {
-    struct command_index * const index_ptr = (struct command_index *)&index;
+    return (struct command_index) {
+        .order = (uint32_t)index,
+        .depth = (uint16_t)(index >> INDEX_DEPTH_SHIFT)
+    };
+}
 
-    return *index_ptr;
+static inline
+struct command_attributes
+command_get_attributes(struct command_buffer const * const buffer,
+                       struct command const * const command)
+{
+    return (struct command_attributes) {
+        .transform = intern_get(buffer->transforms, command->transform),
+        .bounds = intern_get(buffer->bounds, command->bounds)
+    };
 }
 
 static inline
-uint32_t
+uint64_t
 command_index_to_int(struct command_index const index)
 {
-    uint32_t * const index_ptr = (uint32_t *)&index;
+    return ((uint64_t)index.depth << INDEX_DEPTH_SHIFT) | index.order;
+}
+
+#if defined(TERM_USE_COMMAND_BUCKETS)
+/**
+ * Append a command to the bucket at a depth.
+ *
+ * If no bucket is held for the depth yet, one is inserted such that the list
+ * of buckets remains sorted. This only happens the first time a depth is
+ * pushed to; after that, the bucket is found by binary search (or directly,
+ * if it was also the last one pushed to).
+ */
+static
+void
+command_bucket_push(struct command_buckets * const buckets,
+                    uint16_t const depth,
+                    uint32_t const slot)
+{
+    size_t i = buckets->last;
+
+    if (i >= buckets->count || buckets->list[i].depth != depth) {
+        size_t low = 0;
+        size_t high = buckets->count;
+
+        while (low < high) {
+            size_t const middle = low + (high - low) / 2;
+
+            if (buckets->list[middle].depth < depth) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        i = low;
+
+        if (i == buckets->count || buckets->list[i].depth != depth) {
+            if (buckets->count == buckets->capacity) {
+                buckets->capacity *= 2;
+                buckets->list = realloc(buckets->list,
+                                        sizeof(struct command_bucket) *
+                                        buckets->capacity);
+            }
+
+            memmove(&buckets->list[i + 1],
+                    &buckets->list[i],
+                    sizeof(struct command_bucket) * (buckets->count - i));
+
+            buckets->list[i] = (struct command_bucket) {
+                .slots = malloc(sizeof(uint32_t) * (UINT8_MAX + 1)),
+                .capacity = UINT8_MAX + 1,
+                .count = 0,
+                .depth = depth
+            };
+
+            buckets->count += 1;
+        }
+
+        buckets->last = i;
+    }
+
+    struct command_bucket * const bucket = &buckets->list[i];
+
+    if (bucket->count == bucket->capacity) {
+        bucket->capacity *= 2;
+        bucket->slots = realloc(bucket->slots,
+                                sizeof(uint32_t) * bucket->capacity);
+    }
+
+    bucket->slots[bucket->count] = slot;
+    bucket->count += 1;
+}
+
+static
+void
+command_bucket_release(struct command_buckets * const buckets)
+{
+    for (size_t i = 0; i < buckets->count; i++) {
+        free(buckets->list[i].slots);
+    }
 
-    return *index_ptr;
+    free(buckets->list);
 }
+#elif defined(TERM_USE_RADIX_SORT)
+/**
+ * Sort the keys of all commands in a buffer.
+ *
+ * This is a stable LSD radix sort that passes over the depth a byte at a time,
+ * starting with the least significant byte. Because keys are pushed in call
+ * order, and the sort is stable, commands at the same depth remain in call
+ * order without having to sort on it.
+ *
+ * Passes where every key falls into the same bucket are skipped entirely;
+ * this is common for the most significant bytes when a frame only makes
+ * use of a few layers.
+ *
+ * Return a pointer to the sorted keys.
+ */
+static
+struct command_key const *
+command_sort(struct command_buffer * const buffer)
+{
+    size_t histogram[RADIX_PASSES][RADIX_SIZE];
+
+    if (buffer->count == 0) {
+        return buffer->keys;
+    }
 
+    memset(histogram, 0, sizeof(histogram));
+
+    // count occurrences for every pass in one go
+    for (size_t i = 0; i < buffer->count; i++) {
+        uint32_t const depth = buffer->keys[i].depth;
+
+        for (size_t pass = 0; pass < RADIX_PASSES; pass++) {
+            uint32_t const radix = (depth >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1);
+
+            histogram[pass][radix] += 1;
+        }
+    }
+
+    struct command_key * keys = buffer->keys;
+    struct command_key * sorted_keys = buffer->sorted_keys;
+
+    for (size_t pass = 0; pass < RADIX_PASSES; pass++) {
+        size_t * const counts = histogram[pass];
+
+        uint32_t const radix = (keys[0].depth >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1);
+
+        if (counts[radix] == buffer->count) {
+            // all keys share this radix; nothing to sort
+            continue;
+        }
+
+        // determine offsets for each bucket
+        size_t offset = 0;
+
+        for (size_t i = 0; i < RADIX_SIZE; i++) {
+            size_t const count = counts[i];
+
+            counts[i] = offset;
+
+            offset += count;
+        }
+
+        for (size_t i = 0; i < buffer->count; i++) {
+            struct command_key const key = keys[i];
+
+            uint32_t const key_radix = (key.depth >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1);
+
+            sorted_keys[counts[key_radix]] = key;
+
+            counts[key_radix] += 1;
+        }
+
+        struct command_key * const swap = keys;
+
+        keys = sorted_keys;
+        sorted_keys = swap;
+    }
+
+    // the sorted keys may have ended up in either array depending on the
+    // number of passes made; either way, keep both arrays around for next frame
+    buffer->keys = keys;
+    buffer->sorted_keys = sorted_keys;
+
+    return keys;
+}
+#else
 static
 int32_t
 command_compare(void const * const cmd,
@@ -171,3 +649,4 @@ command_compare(void const * const cmd,
 
     return 0;
 }
+#endif
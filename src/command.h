@@ -5,35 +5,153 @@
 #include <termlike/bounds.h> // term_bounds :completeness
 #include <termlike/transform.h> // term_transform :completeness
 
-#include <stdint.h> // uint32_t
+#include <stdint.h> // uint32_t, uint64_t
 #include <stddef.h> // size_t
 
 struct term_layer;
+struct term_grid;
+struct term_text;
+struct graphics_glyph;
 
 struct command_buffer;
 
-struct command {
+/**
+ * Represents the kind of content that a command holds.
+ */
+enum command_type {
+    /**
+     * The command holds a string of text to be printed.
+     */
+    COMMAND_TYPE_TEXT,
+    /**
+     * The command holds a set of glyphs that have already been laid out.
+     */
+    COMMAND_TYPE_GLYPHS,
+    /**
+     * The command holds a grid of cells to be printed.
+     */
+    COMMAND_TYPE_CELLS,
+    /**
+     * The command holds an editable text to be printed.
+     */
+    COMMAND_TYPE_TEXT_OBJECT
+};
+
+/**
+ * Represents a set of glyphs that have already been laid out.
+ */
+struct command_glyphs {
+    struct graphics_glyph const * glyphs;
+    size_t count;
+};
+
+union command_content {
     char const * text;
-    struct term_transform transform;
+    struct command_glyphs const * glyphs;
+    struct term_grid const * grid;
+    struct term_text * text_object;
+};
+
+/**
+ * Represents a command to be issued when a buffer is flushed.
+ *
+ * Transformations and bounds are rarely unique to a single command, so they
+ * are not held by commands directly; instead they are interned in the buffer
+ * (see `command_intern_transform` and `command_intern_bounds`) and referred
+ * to by id. This keeps commands small, which matters since every command is
+ * copied into, and read back from, the buffer at least once per frame.
+ */
+struct command {
+    union command_content content;
+    uint64_t index;
     struct term_location origin;
-    struct term_bounds bounds;
     struct term_color color;
-    uint32_t index;
+    /**
+     * The id of an interned transformation.
+     */
+    uint32_t transform;
+    /**
+     * The id of interned bounds.
+     */
+    uint32_t bounds;
+    enum command_type type;
+    /**
+     * The id of the font to print with.
+     */
+    uint8_t font;
+};
+
+/**
+ * Represents the interned attributes of a command, as resolved on flush.
+ */
+struct command_attributes {
+    struct term_transform const * transform;
+    struct term_bounds const * bounds;
 };
 
-typedef void command_callback(struct command const *);
+/**
+ * Represents a function invoked for each command in a buffer.
+ *
+ * Functions that require stateful callbacks can provide a generic void pointer
+ * that will be passed along with each issued callback.
+ */
+typedef void command_callback(struct command const *,
+                              struct command_attributes,
+                              void *);
 
 struct command_buffer * command_init(void);
 void command_release(struct command_buffer *);
 
 void command_push(struct command_buffer *, struct command);
-void command_flush(struct command_buffer *, command_callback *);
+/**
+ * Allocate a block of memory that remains valid until the buffer is flushed.
+ *
+ * This can be used to hold copies of transient data referenced by commands.
+ */
+void * command_alloc(struct command_buffer *, size_t size);
+/**
+ * Copy a string into memory that remains valid until the buffer is flushed.
+ */
+char const * command_copy_str(struct command_buffer *, char const *);
+/**
+ * Intern a transformation until the buffer is flushed.
+ *
+ * Return an id that commands can refer to the transformation by.
+ */
+uint32_t command_intern_transform(struct command_buffer *,
+                                  struct term_transform const *);
+/**
+ * Intern bounds until the buffer is flushed.
+ *
+ * Return an id that commands can refer to the bounds by.
+ */
+uint32_t command_intern_bounds(struct command_buffer *,
+                               struct term_bounds const *);
+void command_flush(struct command_buffer *, command_callback *, void *);
+/**
+ * Append all commands in a buffer to the end of another buffer.
+ *
+ * Merged commands keep their depth, but are ordered after any command already
+ * pushed to the receiving buffer, while remaining in call order relative to
+ * each other.
+ *
+ * Any memory referenced by merged commands (see `command_alloc`) is still
+ * owned by the buffer they were merged from. That buffer must not be flushed
+ * until the receiving buffer has been flushed.
+ */
+void command_merge(struct command_buffer *, struct command_buffer const *);
 
-float command_index_to_z(uint32_t index);
+float command_index_to_z(uint64_t index);
 
-uint32_t command_next_layered_index(struct command_buffer const *,
+uint64_t command_next_layered_index(struct command_buffer const *,
                                     struct term_layer);
+/**
+ * Return the next index at the same depth as another index.
+ */
+uint64_t command_next_depth_index(struct command_buffer const *,
+                                  uint64_t index);
 
 #ifdef TERM_INCLUDE_PROFILER
 void command_get_capacity(struct command_buffer const *, size_t * used, size_t * cap);
+void command_get_arena_usage(struct command_buffer const *, size_t * used, size_t * peak);
 #endif
@@ -17,7 +17,10 @@ defaults(char const * const title)
         },
         .pixel_size = 1,
         .fullscreen = false,
-        .vsync = true
+        .vsync = true,
+        .copy_text = false,
+        .threads = 1,
+        .max_glyphs = 131072
     };
 }
 
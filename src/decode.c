@@ -0,0 +1,457 @@
+#include "decode.h" // decode_utf8, decode_count, decode_cp437
+
+#include <termlike/graphics/codepage.h> // codepage, codepage_index, CODEPAGE_*
+
+#include <stdint.h> // uint8_t, uint32_t, uint64_t, int32_t
+#include <stddef.h> // size_t, NULL
+#include <stdbool.h> // bool
+
+#include <string.h> // memcpy, memset
+
+#include <utf8.h> // utf8_decode
+
+#if defined(__AVX2__)
+ #define DECODE_USE_AVX2
+ #include <immintrin.h> // _mm256_*, _mm_*
+#elif defined(__SSE2__) || defined(_M_X64) || \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #define DECODE_USE_SSE2
+ #include <emmintrin.h> // _mm_*
+#endif
+
+/**
+ * The number of bytes checked (and widened) at a time.
+ */
+#if defined(DECODE_USE_AVX2)
+ #define DECODE_BLOCK_SIZE 32
+#elif defined(DECODE_USE_SSE2)
+ #define DECODE_BLOCK_SIZE 16
+#else
+ #define DECODE_BLOCK_SIZE 8
+#endif
+
+/**
+ * The number of bytes read when decoding a multibyte sequence.
+ *
+ * This is always 4 bytes, no matter the actual length of the sequence
+ * (see utf8.h).
+ */
+#define DECODE_SEQUENCE_SIZE 4
+
+/**
+ * Determine whether a block of bytes holds only ASCII characters, and if so,
+ * widen each into a codepoint.
+ */
+static inline bool decode_ascii_block(uint8_t const * bytes,
+                                     uint32_t * codepoints);
+/**
+ * Determine whether a block of bytes holds only ASCII characters.
+ */
+static inline bool decode_is_ascii_block(uint8_t const * bytes);
+/**
+ * Count the bytes in a block that are not continuation bytes; i.e. the number
+ * of characters that begin in the block.
+ */
+static inline size_t decode_count_block(uint8_t const * bytes);
+/**
+ * Determine whether a block of bytes holds only printable ASCII characters,
+ * and if so, copy each as a glyph index.
+ */
+static inline bool decode_printable_block(uint8_t const * bytes,
+                                          uint8_t * indices);
+/**
+ * Decode a multibyte sequence.
+ *
+ * Return the number of bytes read.
+ */
+static inline size_t decode_sequence(uint8_t const * bytes,
+                                     size_t remaining,
+                                     uint32_t * codepoint,
+                                     int32_t * error);
+
+size_t
+decode_utf8(char const * const text,
+            size_t const size,
+            uint32_t * const codepoints,
+            size_t const limit,
+            int32_t * const error)
+{
+    uint8_t const * const bytes = (uint8_t const *)text;
+
+    size_t const max_count = limit > 0 ? limit : size;
+
+    size_t offset = 0;
+    size_t count = 0;
+
+    *error = 0;
+
+    while (offset < size && count < max_count) {
+        // widen as many blocks of plain ASCII as possible
+        while (offset + DECODE_BLOCK_SIZE <= size &&
+               count + DECODE_BLOCK_SIZE <= max_count &&
+               decode_ascii_block(&bytes[offset], &codepoints[count])) {
+            offset += DECODE_BLOCK_SIZE;
+            count += DECODE_BLOCK_SIZE;
+        }
+
+        if (offset == size || count == max_count) {
+            break;
+        }
+
+        // the block was either cut short or held a multibyte sequence;
+        // decode characters one by one until reaching the next block
+        size_t const stop = offset + DECODE_BLOCK_SIZE;
+
+        while (offset < size && offset < stop && count < max_count) {
+            if (bytes[offset] < 0x80) {
+                codepoints[count] = bytes[offset];
+
+                offset += 1;
+            } else {
+                offset += decode_sequence(&bytes[offset], size - offset,
+                                          &codepoints[count], error);
+            }
+
+            count += 1;
+        }
+    }
+
+    return count;
+}
+
+size_t
+decode_count(char const * const text,
+             size_t const size,
+             int32_t * const error)
+{
+    uint8_t const * const bytes = (uint8_t const *)text;
+
+    size_t offset = 0;
+    size_t count = 0;
+
+    if (error == NULL) {
+        // count lead bytes a block at a time, then the remainder one by one
+        while (offset + DECODE_BLOCK_SIZE <= size) {
+            count += decode_count_block(&bytes[offset]);
+
+            offset += DECODE_BLOCK_SIZE;
+        }
+
+        while (offset < size) {
+            if ((bytes[offset] & 0xC0) != 0x80) {
+                count += 1;
+            }
+
+            offset += 1;
+        }
+
+        return count;
+    }
+
+    *error = 0;
+
+    while (offset < size) {
+        // skip as many blocks of plain ASCII as possible
+        while (offset + DECODE_BLOCK_SIZE <= size &&
+               decode_is_ascii_block(&bytes[offset])) {
+            offset += DECODE_BLOCK_SIZE;
+            count += DECODE_BLOCK_SIZE;
+        }
+
+        if (offset == size) {
+            break;
+        }
+
+        // the block was either cut short or held a multibyte sequence;
+        // validate characters one by one until reaching the next block
+        size_t const stop = offset + DECODE_BLOCK_SIZE;
+
+        while (offset < size && offset < stop) {
+            if (bytes[offset] < 0x80) {
+                offset += 1;
+            } else {
+                uint32_t codepoint;
+
+                offset += decode_sequence(&bytes[offset], size - offset,
+                                          &codepoint, error);
+            }
+
+            count += 1;
+        }
+    }
+
+    return count;
+}
+
+size_t
+decode_cp437(struct codepage const * const codepage,
+             char const * const text,
+             size_t const size,
+             uint8_t * const indices,
+             size_t const limit,
+             int32_t * const error)
+{
+    uint8_t const * const bytes = (uint8_t const *)text;
+
+    size_t const max_count = limit > 0 ? limit : size;
+
+    size_t offset = 0;
+    size_t count = 0;
+
+    *error = 0;
+
+    while (offset < size && count < max_count) {
+        // copy as many blocks of printable ASCII as possible
+        while (offset + DECODE_BLOCK_SIZE <= size &&
+               count + DECODE_BLOCK_SIZE <= max_count &&
+               decode_printable_block(&bytes[offset], &indices[count])) {
+            offset += DECODE_BLOCK_SIZE;
+            count += DECODE_BLOCK_SIZE;
+        }
+
+        if (offset == size || count == max_count) {
+            break;
+        }
+
+        // the block was either cut short or held anything but printable
+        // ASCII; decode and map characters one by one until reaching the
+        // next block
+        size_t const stop = offset + DECODE_BLOCK_SIZE;
+
+        while (offset < size && offset < stop && count < max_count) {
+            uint8_t const byte = bytes[offset];
+
+            if (byte == '\n') {
+                indices[count] = CODEPAGE_LINEBREAK;
+
+                offset += 1;
+            } else if (byte < 0x80) {
+                indices[count] = codepage_index(codepage, byte);
+
+                offset += 1;
+            } else {
+                uint32_t codepoint;
+
+                offset += decode_sequence(&bytes[offset], size - offset,
+                                          &codepoint, error);
+
+                indices[count] = codepage_index(codepage, codepoint);
+            }
+
+            count += 1;
+        }
+    }
+
+    return count;
+}
+
+static inline
+size_t
+decode_sequence(uint8_t const * const bytes,
+                size_t const remaining,
+                uint32_t * const codepoint,
+                int32_t * const error)
+{
+    int character_error = 0;
+
+    uint8_t const * next;
+    uint8_t const * start = bytes;
+
+    uint8_t tail[DECODE_SEQUENCE_SIZE];
+
+    if (remaining < DECODE_SEQUENCE_SIZE) {
+        // the sequence is at the very end of the string; reading all 4 bytes
+        // would read past it, so decode from a zero-padded copy instead
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, bytes, remaining);
+
+        start = tail;
+    }
+
+    // utf8_decode never writes through the pointer; it only takes a
+    // non-const pointer for the sake of brevity
+    next = utf8_decode((void *)start, codepoint, &character_error);
+
+    *error |= character_error;
+
+    size_t const length = (size_t)(next - start);
+
+    // an invalid sequence could claim to be longer than what remains
+    return length < remaining ? length : remaining;
+}
+
+static inline
+bool
+decode_ascii_block(uint8_t const * const bytes,
+                   uint32_t * const codepoints)
+{
+#if defined(DECODE_USE_AVX2)
+    __m256i const block = _mm256_loadu_si256((__m256i const *)bytes);
+
+    if (_mm256_movemask_epi8(block) != 0) {
+        // at least one byte has its high bit set
+        return false;
+    }
+
+    for (size_t i = 0; i < 4; i++) {
+        __m128i const eight = _mm_loadl_epi64((__m128i const *)&bytes[i * 8]);
+
+        _mm256_storeu_si256((__m256i *)&codepoints[i * 8],
+                            _mm256_cvtepu8_epi32(eight));
+    }
+#elif defined(DECODE_USE_SSE2)
+    __m128i const block = _mm_loadu_si128((__m128i const *)bytes);
+
+    if (_mm_movemask_epi8(block) != 0) {
+        // at least one byte has its high bit set
+        return false;
+    }
+
+    __m128i const zero = _mm_setzero_si128();
+
+    __m128i const low = _mm_unpacklo_epi8(block, zero);
+    __m128i const high = _mm_unpackhi_epi8(block, zero);
+
+    _mm_storeu_si128((__m128i *)&codepoints[0], _mm_unpacklo_epi16(low, zero));
+    _mm_storeu_si128((__m128i *)&codepoints[4], _mm_unpackhi_epi16(low, zero));
+    _mm_storeu_si128((__m128i *)&codepoints[8], _mm_unpacklo_epi16(high, zero));
+    _mm_storeu_si128((__m128i *)&codepoints[12], _mm_unpackhi_epi16(high, zero));
+#else
+    uint64_t block;
+
+    memcpy(&block, bytes, sizeof(block));
+
+    if (block & 0x8080808080808080ULL) {
+        // at least one byte has its high bit set
+        return false;
+    }
+
+    for (size_t i = 0; i < DECODE_BLOCK_SIZE; i++) {
+        codepoints[i] = bytes[i];
+    }
+#endif
+    return true;
+}
+
+static inline
+bool
+decode_is_ascii_block(uint8_t const * const bytes)
+{
+#if defined(DECODE_USE_AVX2)
+    __m256i const block = _mm256_loadu_si256((__m256i const *)bytes);
+
+    return _mm256_movemask_epi8(block) == 0;
+#elif defined(DECODE_USE_SSE2)
+    __m128i const block = _mm_loadu_si128((__m128i const *)bytes);
+
+    return _mm_movemask_epi8(block) == 0;
+#else
+    uint64_t block;
+
+    memcpy(&block, bytes, sizeof(block));
+
+    return (block & 0x8080808080808080ULL) == 0;
+#endif
+}
+
+static inline
+size_t
+decode_count_block(uint8_t const * const bytes)
+{
+    // continuation bytes are 0x80-0xBF; i.e. -128 to -65 as signed bytes,
+    // so anything greater than -65 begins a character
+#if defined(DECODE_USE_AVX2)
+    __m256i const block = _mm256_loadu_si256((__m256i const *)bytes);
+
+    __m256i const leads = _mm256_and_si256(
+        _mm256_cmpgt_epi8(block, _mm256_set1_epi8(-65)),
+        _mm256_set1_epi8(1));
+
+    // sum each group of 8 ones (or zeros) into a 64-bit lane
+    __m256i const sums = _mm256_sad_epu8(leads, _mm256_setzero_si256());
+
+    __m128i const halves = _mm_add_epi64(_mm256_castsi256_si128(sums),
+                                         _mm256_extracti128_si256(sums, 1));
+
+    return (size_t)(_mm_cvtsi128_si32(halves) +
+                    _mm_cvtsi128_si32(_mm_srli_si128(halves, 8)));
+#elif defined(DECODE_USE_SSE2)
+    __m128i const block = _mm_loadu_si128((__m128i const *)bytes);
+
+    __m128i const leads = _mm_and_si128(
+        _mm_cmpgt_epi8(block, _mm_set1_epi8(-65)),
+        _mm_set1_epi8(1));
+
+    // sum each group of 8 ones (or zeros) into a 64-bit lane
+    __m128i const sums = _mm_sad_epu8(leads, _mm_setzero_si128());
+
+    return (size_t)(_mm_cvtsi128_si32(sums) +
+                    _mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+#else
+    uint64_t block;
+
+    memcpy(&block, bytes, sizeof(block));
+
+    // the high bit of each byte is set only for continuation bytes; i.e.
+    // those with their high bit set, but not the one right below it
+    uint64_t const continuations =
+        (block & ~(block << 1)) & 0x8080808080808080ULL;
+
+    // gather the high bits into a count in the topmost byte
+    size_t const count =
+        (size_t)(((continuations >> 7) * 0x0101010101010101ULL) >> 56);
+
+    return DECODE_BLOCK_SIZE - count;
+#endif
+}
+
+static inline
+bool
+decode_printable_block(uint8_t const * const bytes,
+                       uint8_t * const indices)
+{
+    // note that printable ASCII characters (32-126) are at the same indices
+    // in the codepage, so they can be copied as-is
+#if defined(DECODE_USE_AVX2)
+    __m256i const block = _mm256_loadu_si256((__m256i const *)bytes);
+
+    // compared as signed bytes; anything with its high bit set is negative,
+    // and so falls below the lower limit
+    __m256i const printable = _mm256_and_si256(
+        _mm256_cmpgt_epi8(block, _mm256_set1_epi8(31)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8(127), block));
+
+    if (_mm256_movemask_epi8(printable) != -1) {
+        return false;
+    }
+
+    _mm256_storeu_si256((__m256i *)indices, block);
+#elif defined(DECODE_USE_SSE2)
+    __m128i const block = _mm_loadu_si128((__m128i const *)bytes);
+
+    // compared as signed bytes; anything with its high bit set is negative,
+    // and so falls below the lower limit
+    __m128i const printable = _mm_and_si128(
+        _mm_cmpgt_epi8(block, _mm_set1_epi8(31)),
+        _mm_cmplt_epi8(block, _mm_set1_epi8(127)));
+
+    if (_mm_movemask_epi8(printable) != 0xFFFF) {
+        return false;
+    }
+
+    _mm_storeu_si128((__m128i *)indices, block);
+#else
+    bool printable = true;
+
+    for (size_t i = 0; i < DECODE_BLOCK_SIZE; i++) {
+        printable &= (bytes[i] >= 32 && bytes[i] <= 126);
+    }
+
+    if (!printable) {
+        return false;
+    }
+
+    memcpy(indices, bytes, DECODE_BLOCK_SIZE);
+#endif
+    return true;
+}
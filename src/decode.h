@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h> // uint8_t, uint32_t, int32_t
+#include <stddef.h> // size_t
+
+struct codepage;
+
+/**
+ * Decode a UTF8 encoded string of a known size (in bytes) into codepoints.
+ *
+ * Runs of ASCII characters are widened many at a time, while anything else is
+ * decoded one character at a time. No byte past the size of the string is
+ * ever read; i.e. the string need neither be null-terminated nor padded.
+ *
+ * If limit is not zero, decoding stops after that many codepoints. The
+ * codepoints must have room for as many codepoints as the limit or, if there
+ * is no limit, as many codepoints as the string has bytes.
+ *
+ * Return the number of decoded codepoints. If any invalid sequence is
+ * encountered, error is set to a non-zero value (see utf8.h).
+ */
+size_t decode_utf8(char const * text,
+                   size_t size,
+                   uint32_t * codepoints,
+                   size_t limit,
+                   int32_t * error);
+
+/**
+ * Count the characters of a UTF8 encoded string of a known size (in bytes),
+ * without decoding them.
+ *
+ * Every byte that is not a continuation byte begins a character, and such
+ * bytes are counted many at a time. No byte past the size of the string is
+ * ever read.
+ *
+ * If error is provided, the string is also validated; this requires decoding
+ * any multibyte sequences (runs of ASCII are still counted many at a time).
+ * If any invalid sequence is encountered, error is set to a non-zero value
+ * (see utf8.h), and the count is that of the decoded codepoints.
+ */
+size_t decode_count(char const * text, size_t size, int32_t * error);
+
+/**
+ * Decode a UTF8 encoded string of a known size (in bytes) directly into
+ * indices of glyphs in a codepage (see codepage.h).
+ *
+ * This works just like `decode_utf8`, except that each character is mapped
+ * to its glyph index as it is decoded. Linebreaks are decoded into
+ * `CODEPAGE_LINEBREAK`, and characters that are not in the codepage are
+ * decoded into `CODEPAGE_UNKNOWN`.
+ *
+ * Runs of printable ASCII characters map directly to glyph indices, and are
+ * copied many at a time; as such, the codepage must map printable ASCII
+ * characters to glyphs at the same indices (as CP437 does).
+ */
+size_t decode_cp437(struct codepage const *,
+                    char const * text,
+                    size_t size,
+                    uint8_t * indices,
+                    size_t limit,
+                    int32_t * error);
@@ -0,0 +1,5 @@
+#include <termlike/font.h> // term_font
+
+struct term_font const TERM_FONT_DEFAULT = {
+    .id = 0
+};
@@ -0,0 +1,74 @@
+#include <termlike/graphics/codepage.h> // codepage, codepage_*, CODEPAGE_*
+
+#include <stdlib.h> // malloc, free
+#include <stdint.h> // uint8_t, uint16_t, uint32_t, UINT8_MAX
+#include <stddef.h> // size_t
+
+#include <string.h> // memset
+
+#ifdef DEBUG
+ #include <assert.h> // assert
+#endif
+
+extern inline uint8_t codepage_index(struct codepage const *, uint32_t code);
+
+struct codepage *
+codepage_init(uint32_t const * const codes, size_t const count)
+{
+#ifdef DEBUG
+    assert(count <= UINT8_MAX + 1 /* glyph indices must fit in a byte */);
+#endif
+    struct codepage * const codepage = malloc(sizeof(struct codepage));
+
+    // every page starts out referring to the shared table of unknowns
+    memset(codepage->directory, 0, sizeof(codepage->directory));
+
+    codepage->table_count = 1;
+
+    // first pass: determine pages in use, so that all tables can be
+    // allocated in one go
+    for (size_t i = 0; i < count; i++) {
+        if (codes[i] > CODEPAGE_MAX_CODE) {
+            continue;
+        }
+
+        uint16_t * const table =
+            &codepage->directory[codes[i] / CODEPAGE_PAGE_SIZE];
+
+        if (*table == 0) {
+            *table = (uint16_t)codepage->table_count;
+
+            codepage->table_count += 1;
+        }
+    }
+
+    size_t const size = codepage->table_count * CODEPAGE_PAGE_SIZE;
+
+    codepage->tables = malloc(sizeof(uint8_t) * size);
+
+    memset(codepage->tables, CODEPAGE_UNKNOWN, sizeof(uint8_t) * size);
+
+    // second pass: map each codepoint to its glyph; going backwards so that
+    // the lowest index wins for any repeated codepoint
+    for (size_t i = count; i > 0; i--) {
+        uint32_t const code = codes[i - 1];
+
+        if (code > CODEPAGE_MAX_CODE) {
+            continue;
+        }
+
+        uint16_t const table = codepage->directory[code / CODEPAGE_PAGE_SIZE];
+
+        codepage->tables[(table * CODEPAGE_PAGE_SIZE) +
+                         (code % CODEPAGE_PAGE_SIZE)] = (uint8_t)(i - 1);
+    }
+
+    return codepage;
+}
+
+void
+codepage_release(struct codepage * const codepage)
+{
+    free(codepage->tables);
+    free(codepage);
+}
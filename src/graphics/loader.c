@@ -24,7 +24,8 @@
 bool
 load_image_data(uint8_t const * const buffer,
                 int32_t const length,
-                image_loaded_callback * const callback)
+                image_loaded_callback * const callback,
+                void * const data)
 {
     stbi_set_flip_vertically_on_load(true);
 
@@ -41,7 +42,7 @@ load_image_data(uint8_t const * const buffer,
     }
 
     if (callback) {
-        callback(image);
+        callback(image, data);
     }
 
     stbi_image_free(image.data);
@@ -0,0 +1,222 @@
+#include "quad.h" // glyph_transform, glyph_rotation, glyphs_*
+
+#include <stdint.h> // uint8_t, uint16_t, uint32_t, int32_t
+#include <stdbool.h> // bool
+
+#include <string.h> // memcpy
+#include <math.h> // floorf, sinf, cosf
+
+#include "renderable.h" // glyph_vertex, glyph_instance, glyph_uv, texture, vector2, vector3, color
+
+#ifdef DEBUG
+ #include <assert.h> // assert
+#endif
+
+#ifdef TERM_USE_INSTANCING
+/**
+ * Convert a value to a half-precision float.
+ *
+ * Values too small to be represented become zero, and values too large
+ * become the largest representable value.
+ */
+static uint16_t glyphs_half(float value);
+#endif
+
+void
+glyphs_index(uint32_t * const indices, uint32_t const quads)
+{
+    for (uint32_t i = 0; i < quads; i++) {
+        uint32_t const vertex = i * GLYPH_VERTEX_COUNT;
+        uint32_t * const quad = &indices[i * GLYPH_INDEX_COUNT];
+
+        // corners are ordered top-left, bottom-right, bottom-left, top-right
+        // (see glyphs_set_corners); both triangles are wound clockwise
+        quad[0] = vertex + 0;
+        quad[1] = vertex + 1;
+        quad[2] = vertex + 2;
+        quad[3] = vertex + 0;
+        quad[4] = vertex + 3;
+        quad[5] = vertex + 1;
+    }
+}
+
+void
+glyphs_set_corners(struct glyph_vertex (* const vertices)[GLYPH_VERTEX_COUNT],
+                   struct vector2 const extent)
+{
+    float const l = -extent.x;
+    float const r = extent.x;
+    float const b = -extent.y;
+    float const t = extent.y;
+
+    struct vector2 const bl = { .x = l, .y = b };
+    struct vector2 const tl = { .x = l, .y = t };
+    struct vector2 const tr = { .x = r, .y = t };
+    struct vector2 const br = { .x = r, .y = b };
+
+    // corners are drawn as 2 triangles using indices (see glyphs_index)
+    (*vertices)[0].position = (struct vector3) { .x = tl.x, .y = tl.y, .z = 0 };
+    (*vertices)[1].position = (struct vector3) { .x = br.x, .y = br.y, .z = 0 };
+    (*vertices)[2].position = (struct vector3) { .x = bl.x, .y = bl.y, .z = 0 };
+    (*vertices)[3].position = (struct vector3) { .x = tr.x, .y = tr.y, .z = 0 };
+}
+
+void
+glyphs_set_uvs(struct glyph_vertex (* const vertices)[GLYPH_VERTEX_COUNT],
+               struct glyph_uv const uv)
+{
+    struct texture const bl = uv.min;
+    struct texture const tr = uv.max;
+
+    struct texture const tl = {
+        .u = uv.min.u,
+        .v = uv.max.v
+    };
+
+    struct texture const br = {
+        .u = uv.max.u,
+        .v = uv.min.v
+    };
+
+    (*vertices)[0].texture = tl;
+    (*vertices)[1].texture = br;
+    (*vertices)[2].texture = bl;
+    (*vertices)[3].texture = tr;
+}
+
+#ifdef TERM_USE_INSTANCING
+void
+glyphs_instance(struct glyph_transform const transform,
+                struct color const color,
+                uint8_t const index,
+                uint8_t const layer,
+                struct glyph_instance * const instance)
+{
+    float const pi = 3.14159265358979f;
+
+    // wrap the angle into -pi..pi, where half-precision is most precise
+    float const angle = transform.angle -
+        (2 * pi) * floorf((transform.angle + pi) / (2 * pi));
+
+    instance->position = (struct vector3) {
+        .x = transform.origin.x + transform.offset.x,
+        .y = transform.origin.y + transform.offset.y,
+        .z = transform.origin.z
+    };
+
+    // fonts differ in size, so the scale is applied to the extent of the
+    // glyph (from its center to its corners) up front
+    instance->scale[0] = glyphs_half(transform.scale.x * transform.offset.x);
+    instance->scale[1] = glyphs_half(transform.scale.y * transform.offset.y);
+    instance->angle = glyphs_half(angle);
+    instance->index = index;
+    instance->layer = layer;
+    instance->color = color;
+}
+#endif
+
+void
+glyphs_rotate(struct glyph_rotation * const rotation,
+              float const angle)
+{
+    if (angle > rotation->angle || angle < rotation->angle) {
+        rotation->angle = angle;
+        rotation->sine = sinf(angle);
+        rotation->cosine = cosf(angle);
+    }
+}
+
+void
+glyphs_transform(struct glyph_vertex const (* const vertices)[GLYPH_VERTEX_COUNT],
+                 struct glyph_transform const transform,
+                 struct glyph_rotation const rotation,
+                 struct glyph_vertex (* const transformed)[GLYPH_VERTEX_COUNT])
+{
+#ifdef DEBUG
+    assert(!(rotation.angle > transform.angle ||
+             rotation.angle < transform.angle) /* rotation must match */);
+#endif
+
+    float const tx = transform.origin.x + transform.offset.x;
+    float const ty = transform.origin.y + transform.offset.y;
+    float const tz = transform.origin.z;
+
+    bool const is_scaled = (transform.scale.x > 1 || transform.scale.x < 1 ||
+                            transform.scale.y > 1 || transform.scale.y < 1);
+    bool const is_rotated = (transform.angle > 0 || transform.angle < 0);
+
+    if (!is_scaled && !is_rotated) {
+        // most glyphs are only ever moved; skip the matrix entirely
+        for (uint16_t i = 0; i < GLYPH_VERTEX_COUNT; i++) {
+            struct glyph_vertex vertex = (*vertices)[i];
+
+            vertex.position.x += tx;
+            vertex.position.y += ty;
+            vertex.position.z += tz;
+
+            (*transformed)[i] = vertex;
+        }
+
+        return;
+    }
+
+    // scaling, then rotating, is a 2x2 matrix in the plane of the glyph:
+    //   | cos * sx   -sin * sy |
+    //   | sin * sx    cos * sy |
+    // without either, this reduces to the identity (sin(0) = 0, cos(0) = 1)
+    float const xx = rotation.cosine * transform.scale.x;
+    float const xy = -rotation.sine * transform.scale.y;
+    float const yx = rotation.sine * transform.scale.x;
+    float const yy = rotation.cosine * transform.scale.y;
+
+    for (uint16_t i = 0; i < GLYPH_VERTEX_COUNT; i++) {
+        struct glyph_vertex vertex = (*vertices)[i];
+
+        float const x = vertex.position.x;
+        float const y = vertex.position.y;
+
+        vertex.position = (struct vector3) {
+            .x = (xx * x) + (xy * y) + tx,
+            .y = (yx * x) + (yy * y) + ty,
+            .z = vertex.position.z + tz
+        };
+
+        (*transformed)[i] = vertex;
+    }
+}
+
+#ifdef TERM_USE_INSTANCING
+static
+uint16_t
+glyphs_half(float const value)
+{
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint16_t const sign = (uint16_t)((bits >> 16) & 0x8000);
+
+    int32_t const exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+
+    uint32_t const mantissa = bits & 0x7FFFFF;
+
+    if (exponent <= 0) {
+        // too small (or zero)
+        return sign;
+    }
+
+    if (exponent >= 31) {
+        // too large (or not a number)
+        return sign | 0x7BFF;
+    }
+
+    uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+
+    if (mantissa & 0x1000) {
+        // round to nearest; a carry into the exponent is still correct
+        half += 1;
+    }
+
+    return (uint16_t)(sign | (half > 0x7BFF ? 0x7BFF : half));
+}
+#endif
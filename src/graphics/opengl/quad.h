@@ -0,0 +1,81 @@
+#pragma once
+
+#include "renderable.h" // glyph_vertex, glyph_instance, vector2, vector3 :completeness
+
+#include <stdint.h> // uint8_t, uint32_t
+
+#define GLYPH_VERTEX_COUNT 4 // 1 vertex per corner of a quad
+#define GLYPH_INDEX_COUNT (2 * 3) // 2 triangles per quad = 6 indices
+
+struct glyph_transform {
+    struct vector3 origin;
+    /**
+     * The offset from the corner of a glyph to its center (i.e. half of its
+     * unscaled size).
+     */
+    struct vector2 offset;
+    struct vector2 scale;
+    float angle;
+};
+
+/**
+ * The sine and cosine of an angle, kept around so that consecutive glyphs
+ * rotated by the same angle (e.g. the characters of a string) need not
+ * compute them again.
+ */
+struct glyph_rotation {
+    float angle;
+    float sine;
+    float cosine;
+};
+
+#define GLYPH_ROTATION_NONE (struct glyph_rotation) { \
+    .angle = 0, .sine = 0, .cosine = 1 \
+}
+
+/**
+ * Write the indices of the corners of a number of consecutive quads, as 2
+ * triangles each (i.e. `GLYPH_INDEX_COUNT` indices per quad).
+ */
+void glyphs_index(uint32_t * indices, uint32_t quads);
+/**
+ * Set the positions of the corners of a glyph, centered on its origin and
+ * reaching out to an extent (i.e. half of its size) on either axis.
+ */
+void glyphs_set_corners(struct glyph_vertex (* vertices)[GLYPH_VERTEX_COUNT],
+                        struct vector2 extent);
+/**
+ * Set the texture coordinates of the corners of a glyph.
+ */
+void glyphs_set_uvs(struct glyph_vertex (* vertices)[GLYPH_VERTEX_COUNT],
+                    struct glyph_uv);
+
+#ifdef TERM_USE_INSTANCING
+/**
+ * Pack a transformed glyph into a single record, leaving its expansion into
+ * a quad to the vertex shader.
+ *
+ * This does not touch any renderer state, and is safe to call from any thread.
+ */
+void glyphs_instance(struct glyph_transform,
+                     struct color,
+                     uint8_t index,
+                     uint8_t layer,
+                     struct glyph_instance *);
+#endif
+/**
+ * Update a rotation to an angle, only computing its sine and cosine if the
+ * angle differs from the current one.
+ */
+void glyphs_rotate(struct glyph_rotation *, float angle);
+/**
+ * Transform the vertices of a glyph.
+ *
+ * The rotation must match the angle of the transform (see `glyphs_rotate`).
+ *
+ * This does not touch any renderer state, and is safe to call from any thread.
+ */
+void glyphs_transform(struct glyph_vertex const (* vertices)[GLYPH_VERTEX_COUNT],
+                      struct glyph_transform,
+                      struct glyph_rotation,
+                      struct glyph_vertex (* transformed)[GLYPH_VERTEX_COUNT]);
@@ -29,7 +29,28 @@ struct renderable {
 struct glyph_vertex {
     struct vector3 position; // 12
     struct color color; // 4
-    struct texture texture; // 4 = 20
+    struct texture texture; // 4
+    uint8_t layer; // 1
+    uint8_t padding[3]; // 3 = 24
+};
+
+/**
+ * Represents a single glyph to be expanded into a quad by the vertex shader.
+ *
+ * This replaces 4 vertices (96 bytes) with a single record (24 bytes).
+ */
+struct glyph_instance {
+    struct vector3 position; // 12
+    uint16_t scale[2]; // 4 (half-precision floats)
+    uint16_t angle; // 2 (half-precision float)
+    uint8_t index; // 1
+    uint8_t layer; // 1
+    struct color color; // 4 = 24
+};
+
+struct glyph_uv {
+    struct texture min;
+    struct texture max;
 };
 
 GLuint graphics_compile_shader(GLenum type, GLchar const * source);
@@ -1,7 +1,7 @@
 #include <termlike/graphics/renderer.h> // graphics_*
 #include <termlike/graphics/viewport.h> // viewport, viewport_clip
 
-#include <termlike/resources/cp437.h> // CP437, CP437_LENGTH
+#include <termlike/platform/workers.h> // workers, workers_*
 
 #include "renderable.h" // renderable, vector2, vector3
 #include "spritebatch.h" // glyph_renderer, glyphs_*
@@ -9,9 +9,9 @@
 #include <stdio.h> // fprintf
 #include <stdlib.h> // malloc, free
 #include <stdbool.h> // bool
-#include <stddef.h> // NULL
+#include <stddef.h> // size_t, NULL
 #include <string.h> // memcpy
-#include <stdint.h> // int16_t, int32_t, uint16_t uint32_t
+#include <stdint.h> // int16_t, int32_t, uint8_t, uint16_t uint32_t
 
 #include <gl3w/GL/gl3w.h> // gl*, GL*
 
@@ -19,6 +19,13 @@
  #include <assert.h> // assert
 #endif
 
+/**
+ * The minimum number of glyphs that each worker expands into vertices.
+ *
+ * Below this amount, waking up workers costs more than it saves.
+ */
+#define MIN_GLYPHS_PER_WORKER 256
+
 struct frame_renderable {
     struct renderable renderable;
     GLuint texture_id;
@@ -31,23 +38,108 @@ struct frame_vertex {
     struct texture texture;
 };
 
-struct glyph_uv {
-    struct texture min;
-    struct texture max;
-};
-
-struct graphics_shared {
-    struct glyph_uv glyph_uvs[256];
+/**
+ * Represents a font held by a layer of the font texture array.
+ */
+struct graphics_layer {
+    struct glyph_uv glyph_uvs[GLYPH_UV_COUNT];
+#ifndef TERM_USE_INSTANCING
     struct glyph_vertex glyph_vertices[GLYPH_VERTEX_COUNT];
+#endif
     struct graphics_scale glyph;
     struct graphics_scale glyph_half;
+    struct graphics_font font;
+    /**
+     * A copy of the font image.
+     *
+     * Every layer of a texture array has the same size, so adding a larger
+     * font requires creating the array anew, along with every font in it.
+     */
+    struct graphics_image image;
+};
+
+struct graphics_shared {
+    struct graphics_layer layers[GLYPH_LAYER_COUNT];
+    /**
+     * The size of every layer of the font texture array (in pixels).
+     */
+    struct graphics_scale texture;
+    uint8_t layer_count;
+};
+
+/**
+ * Represents a run of glyphs waiting to be expanded into vertices.
+ */
+struct glyph_span {
+    /**
+     * The drawn glyphs, as passed to `graphics_draw_glyphs`.
+     *
+     * When not set, the glyphs were drawn one at a time, and are held by the
+     * queue instead (beginning at `first`).
+     */
+    struct graphics_glyph const * glyphs;
+    size_t first;
+    size_t count;
+    /**
+     * The position of the first glyph of the span among all queued glyphs;
+     * i.e. the sum of the counts of all preceding spans.
+     */
+    size_t offset;
+};
+
+/**
+ * Represents glyphs waiting to be expanded into vertices.
+ *
+ * Glyphs drawn as a set are not copied, only referred to by a span, which
+ * is why they must remain valid until the end of the frame. Glyphs drawn
+ * one at a time have nowhere else to be, so they are held by the queue.
+ */
+struct glyph_queue {
+    struct glyph_span * spans;
+    struct graphics_glyph * glyphs;
+    size_t span_count;
+    size_t span_capacity;
+    size_t glyph_count;
+    size_t glyph_capacity;
+    /**
+     * The number of glyphs in all spans.
+     */
+    size_t count;
+};
+
+/**
+ * Represents a range of queued glyphs to be expanded into vertices by
+ * workers.
+ */
+struct glyph_expansion {
+    struct graphics_context const * context;
+    struct glyph_queue const * queue;
+    /**
+     * The position of the first glyph of the range among all queued glyphs.
+     */
+    size_t offset;
+#ifdef TERM_USE_INSTANCING
+    struct glyph_instance * instances;
+#else
+    struct glyph_vertex * vertices;
+#endif
+    size_t count;
 };
 
 struct graphics_context {
     struct graphics_shared shared;
     struct glyph_renderer * glyphs;
+    /**
+     * The workers expanding glyphs into vertices, if using more than one thread.
+     *
+     * When not set, each glyph is expanded immediately as it is drawn.
+     */
+    struct workers * workers;
+    /**
+     * The glyphs drawn since last expanding into vertices.
+     */
+    struct glyph_queue * queue;
     struct frame_renderable screen;
-    struct graphics_font font;
     struct viewport viewport;
     struct viewport_clip clip;
     struct color clear;
@@ -55,12 +147,9 @@ struct graphics_context {
     GLuint font_texture_id;
 };
 
-static uint32_t cache_previous_code = 0;
-static uint32_t cache_previous_index = 0;
-
 static void graphics_process_errors(void);
 
-static void graphics_setup(struct graphics_context *);
+static void graphics_setup(struct graphics_context *, size_t max_glyphs);
 static void graphics_teardown(struct graphics_context *);
 
 static void graphics_setup_screen_shader(struct graphics_context *);
@@ -68,18 +157,64 @@ static void graphics_setup_screen_texture(struct graphics_context *);
 static void graphics_setup_screen_buffer(struct graphics_context *);
 static void graphics_setup_screen_vbo(struct graphics_context *);
 
-static void graphics_create_texture(struct graphics_image, GLuint * texture_id);
-
-static uint32_t graphics_get_table_index(uint32_t code);
-
-static void graphics_set_position(struct glyph_vertex (*)[GLYPH_VERTEX_COUNT],
-                                  struct graphics_scale halved_glyph);
-
-static void graphics_set_uv(struct glyph_vertex (*)[GLYPH_VERTEX_COUNT],
-                            struct glyph_uv);
-
+/**
+ * Create a texture array holding every added font, one font per layer.
+ */
+static void graphics_create_font_texture(struct graphics_shared const *,
+                                         GLuint * texture_id);
+/**
+ * Calculate texture coordinates and vertices of every glyph in a font.
+ */
+static void graphics_setup_layer(struct graphics_layer *,
+                                 uint8_t layer,
+                                 struct graphics_scale texture);
+
+#ifdef TERM_USE_INSTANCING
+/**
+ * Expand a glyph into an instance; its vertices are expanded when drawn.
+ */
+static void graphics_expand(struct graphics_context const *,
+                            struct graphics_glyph const *,
+                            struct glyph_instance *);
+#else
+/**
+ * Expand a glyph into transformed vertices.
+ *
+ * The rotation is carried over between consecutive glyphs, and is only
+ * computed again when the angle changes.
+ */
+static void graphics_expand(struct graphics_context const *,
+                            struct graphics_glyph const *,
+                            struct glyph_rotation *,
+                            struct glyph_vertex (*)[GLYPH_VERTEX_COUNT]);
+#endif
+/**
+ * Expand all queued glyphs into vertices, splitting the work across workers.
+ */
+static void graphics_expand_queue(struct graphics_context *);
+/**
+ * Expand a range of glyphs into vertices.
+ *
+ * Each worker expands a disjoint range of glyphs, and writes vertices
+ * directly into the reserved part of the batch.
+ *
+ * This function can be passed to `workers_run` as a callback.
+ */
+static void graphics_expand_range(size_t worker, size_t count, void *);
+/**
+ * Find the span holding the queued glyph at a position.
+ */
+static size_t graphics_find_span(struct glyph_queue const *, size_t position);
+
+static void graphics_queue_span(struct glyph_queue *,
+                                struct graphics_glyph const *,
+                                size_t first,
+                                size_t count);
+
+#ifndef TERM_USE_INSTANCING
 static void graphics_set_tint(struct glyph_vertex (*)[GLYPH_VERTEX_COUNT],
                               struct graphics_color);
+#endif
 
 static void graphics_get_transform(struct graphics_transform,
                                    struct viewport,
@@ -87,13 +222,32 @@ static void graphics_get_transform(struct graphics_transform,
                                    struct glyph_transform *);
 
 struct graphics_context *
-graphics_init(struct viewport const viewport)
+graphics_init(struct viewport const viewport,
+              size_t const threads,
+              size_t const max_glyphs)
 {
     struct graphics_context * context = malloc(sizeof(struct graphics_context));
 
     context->viewport = viewport;
 
-    graphics_setup(context);
+    context->workers = NULL;
+    context->queue = NULL;
+
+    if (threads > 1) {
+        context->workers = workers_init(threads);
+        context->queue = malloc(sizeof(struct glyph_queue));
+        context->queue->count = 0;
+        context->queue->span_count = 0;
+        context->queue->span_capacity = MIN_GLYPHS_PER_WORKER;
+        context->queue->spans = malloc(sizeof(struct glyph_span) *
+                                       context->queue->span_capacity);
+        context->queue->glyph_count = 0;
+        context->queue->glyph_capacity = MIN_GLYPHS_PER_WORKER * threads;
+        context->queue->glyphs = malloc(sizeof(struct graphics_glyph) *
+                                        context->queue->glyph_capacity);
+    }
+
+    graphics_setup(context, max_glyphs);
 
     return context;
 }
@@ -103,6 +257,14 @@ graphics_release(struct graphics_context * const context)
 {
     graphics_teardown(context);
 
+    if (context->workers != NULL) {
+        workers_release(context->workers);
+
+        free(context->queue->spans);
+        free(context->queue->glyphs);
+        free(context->queue);
+    }
+
     free(context);
 }
 
@@ -128,6 +290,10 @@ graphics_begin(struct graphics_context * const context)
 void
 graphics_end(struct graphics_context * const context)
 {
+    if (context->workers != NULL) {
+        graphics_expand_queue(context);
+    }
+
     glyphs_end(context->glyphs);
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0); {
@@ -163,60 +329,164 @@ void
 graphics_draw(struct graphics_context const * const context,
               struct graphics_color const color,
               struct graphics_transform const transform,
-              uint32_t const code)
+              uint8_t const index,
+              uint8_t const font)
 {
-    bool const use_cache = code == cache_previous_code;
+    struct graphics_glyph const glyph = (struct graphics_glyph) {
+        .transform = transform,
+        .color = color,
+        .index = index,
+        .font = font
+    };
 
-    uint32_t const table_index = use_cache ?
-        cache_previous_index : graphics_get_table_index(code);
+    if (context->workers != NULL) {
+        struct glyph_queue * const queue = context->queue;
 
-    cache_previous_code = code;
-    cache_previous_index = table_index;
+        if (queue->glyph_count == queue->glyph_capacity) {
+            queue->glyph_capacity *= 2;
+            queue->glyphs = realloc(queue->glyphs,
+                                    sizeof(struct graphics_glyph) *
+                                    queue->glyph_capacity);
+        }
 
-    struct glyph_vertex vertices[GLYPH_VERTEX_COUNT];
-    struct glyph_uv const uv = context->shared.glyph_uvs[table_index];
+        queue->glyphs[queue->glyph_count] = glyph;
 
-    memcpy(&vertices, context->shared.glyph_vertices,
-           sizeof(context->shared.glyph_vertices));
+        graphics_queue_span(queue, NULL, queue->glyph_count, 1);
 
-    graphics_set_uv(&vertices, uv);
-    graphics_set_tint(&vertices, color);
+        queue->glyph_count += 1;
 
-    struct glyph_transform glyph_transform;
+        return;
+    }
 
-    graphics_get_transform(transform,
-                           context->viewport,
-                           context->shared.glyph,
-                           &glyph_transform);
+    graphics_draw_glyphs(context, &glyph, 1);
+}
 
-    glyph_transform.offset = (struct vector2) {
-        .x = context->shared.glyph_half.horizontal,
-        .y = context->shared.glyph_half.vertical
-    };
+void
+graphics_draw_glyphs(struct graphics_context const * const context,
+                     struct graphics_glyph const * const glyphs,
+                     size_t const count)
+{
+    if (context->workers != NULL) {
+        // defer expansion until all glyphs of the frame have been drawn
+        if (count > 0) {
+            graphics_queue_span(context->queue, glyphs, 0, count);
+        }
+
+        return;
+    }
 
-    glyphs_add(context->glyphs, &vertices, glyph_transform,
-               context->font_texture_id);
+#ifndef TERM_USE_INSTANCING
+    struct glyph_rotation rotation = GLYPH_ROTATION_NONE;
+#endif
+
+    for (size_t i = 0; i < count; i++) {
+#ifdef TERM_USE_INSTANCING
+        struct glyph_instance * instance;
+
+        glyphs_reserve(context->glyphs, 1, context->font_texture_id,
+                       &instance);
+
+        graphics_expand(context, &glyphs[i], instance);
+#else
+        struct glyph_vertex * vertices;
+
+        glyphs_reserve(context->glyphs, 1, context->font_texture_id,
+                       &vertices);
+
+        graphics_expand(context, &glyphs[i], &rotation,
+                        (struct glyph_vertex (*)[GLYPH_VERTEX_COUNT])vertices);
+#endif
+    }
 }
 
 void
 graphics_get_font(struct graphics_context const * const context,
+                  uint8_t const id,
                   struct graphics_font * const font)
 {
-    *font = context->font;
+#ifdef DEBUG
+    assert(id < context->shared.layer_count);
+#endif
+    *font = context->shared.layers[id].font;
 }
 
-void
-graphics_set_font(struct graphics_context * const context,
+bool
+graphics_add_font(struct graphics_context * const context,
                   struct graphics_image const image,
-                  struct graphics_font const font)
+                  struct graphics_font const font,
+                  uint8_t * const id)
 {
+    struct graphics_shared * const shared = &context->shared;
+
+    if (shared->layer_count == GLYPH_LAYER_COUNT) {
+        return false;
+    }
+
+    // the glyphs of a font are a grid of squares filling the whole image;
+    // any other size would have glyphs read from the wrong part of the layer
+    bool const is_fitting = (image.width == (int32_t)font.columns * font.size &&
+                             image.height == (int32_t)font.rows * font.size);
+
+    if (!is_fitting) {
+        return false;
+    }
+
+    uint8_t const layer = shared->layer_count;
+
+    // image data is always loaded as RGBA (see loader.c)
+    size_t const size = (size_t)image.width * (size_t)image.height * 4;
+
+    shared->layers[layer].font = font;
+    shared->layers[layer].image = image;
+    shared->layers[layer].image.data = malloc(size);
+
+    memcpy(shared->layers[layer].image.data, image.data, size);
+
+    shared->layer_count += 1;
+
+    bool const is_larger = ((float)image.width > shared->texture.horizontal ||
+                            (float)image.height > shared->texture.vertical);
+
+    if (is_larger) {
+        if ((float)image.width > shared->texture.horizontal) {
+            shared->texture.horizontal = (float)image.width;
+        }
+
+        if ((float)image.height > shared->texture.vertical) {
+            shared->texture.vertical = (float)image.height;
+        }
+    }
+
     if (context->font_texture_id != 0) {
         glDeleteTextures(1, &context->font_texture_id);
     }
 
-    graphics_create_texture(image, &context->font_texture_id);
+    graphics_create_font_texture(shared, &context->font_texture_id);
+
+    // texture coordinates are relative to the size of the array, so a larger
+    // array requires updating those of every font; otherwise only the new one
+    uint8_t const first = is_larger ? 0 : layer;
+
+    for (uint8_t i = first; i < shared->layer_count; i++) {
+        graphics_setup_layer(&shared->layers[i], i, shared->texture);
+
+        glyphs_set_font(context->glyphs, i,
+                        (struct glyph_uv const (*)[GLYPH_UV_COUNT])
+                        &shared->layers[i].glyph_uvs);
+    }
+
+    *id = layer;
 
-    context->font = font;
+    return true;
+}
+
+static
+void
+graphics_setup_layer(struct graphics_layer * const layer,
+                     uint8_t const index,
+                     struct graphics_scale const texture)
+{
+    struct graphics_font const font = layer->font;
 
     // store commonly used values to avoid calculating over and over
     struct graphics_scale const glyph = (struct graphics_scale) {
@@ -224,13 +494,13 @@ graphics_set_font(struct graphics_context * const context,
         .vertical = font.size
     };
 
-    struct graphics_scale const texture = (struct graphics_scale) {
+    struct graphics_scale const extent = (struct graphics_scale) {
         .horizontal = font.columns * glyph.horizontal,
         .vertical = font.rows * glyph.vertical
     };
 
-    context->shared.glyph = glyph;
-    context->shared.glyph_half = (struct graphics_scale) {
+    layer->glyph = glyph;
+    layer->glyph_half = (struct graphics_scale) {
         .horizontal = glyph.horizontal / 2.0f,
         .vertical = glyph.vertical / 2.0f,
     };
@@ -248,7 +518,7 @@ graphics_set_font(struct graphics_context * const context,
             source.y = row * glyph.vertical;
 
             // flip it
-            source.y = (texture.vertical - glyph.vertical) - source.y;
+            source.y = (extent.vertical - glyph.vertical) - source.y;
 
             struct vector2 const min = {
                 .x = (source.x + w) / texture.horizontal,
@@ -260,10 +530,10 @@ graphics_set_font(struct graphics_context * const context,
                 .y = (source.y - h + glyph.vertical) / texture.vertical
             };
 
-            uint16_t const index = (row * 16) + column;
+            uint16_t const glyph_index = (row * 16) + column;
 
             // normalize to fixed-point values
-            context->shared.glyph_uvs[index] = (struct glyph_uv) {
+            layer->glyph_uvs[glyph_index] = (struct glyph_uv) {
                 .min = (struct texture) {
                     .u = (uint16_t)(UINT16_MAX * min.x),
                     .v = (uint16_t)(UINT16_MAX * min.y)
@@ -276,8 +546,21 @@ graphics_set_font(struct graphics_context * const context,
         }
     }
 
-    graphics_set_position(&context->shared.glyph_vertices,
-                          context->shared.glyph_half);
+#ifndef TERM_USE_INSTANCING
+    glyphs_set_corners(&layer->glyph_vertices, (struct vector2) {
+        .x = layer->glyph_half.horizontal,
+        .y = layer->glyph_half.vertical
+    });
+
+    for (uint16_t i = 0; i < GLYPH_VERTEX_COUNT; i++) {
+        layer->glyph_vertices[i].layer = index;
+        layer->glyph_vertices[i].padding[0] = 0;
+        layer->glyph_vertices[i].padding[1] = 0;
+        layer->glyph_vertices[i].padding[2] = 0;
+    }
+#else
+    (void)index;
+#endif
 }
 
 void
@@ -299,7 +582,8 @@ graphics_get_viewport(struct graphics_context const * const context,
 
 static
 void
-graphics_setup(struct graphics_context * const context)
+graphics_setup(struct graphics_context * const context,
+               size_t const max_glyphs)
 {
     glClearDepth(1.0);
 
@@ -322,11 +606,14 @@ graphics_setup(struct graphics_context * const context)
         .a = 255
     };
 
-    context->font.columns = 0;
-    context->font.rows = 0;
+    context->shared.layer_count = 0;
+    context->shared.texture = (struct graphics_scale) {
+        .horizontal = 0,
+        .vertical = 0
+    };
     context->font_texture_id = 0;
 
-    context->glyphs = glyphs_init(context->viewport);
+    context->glyphs = glyphs_init(context->viewport, max_glyphs);
 }
 
 static
@@ -335,6 +622,10 @@ graphics_teardown(struct graphics_context * const context)
 {
     glyphs_release(context->glyphs);
 
+    for (uint8_t i = 0; i < context->shared.layer_count; i++) {
+        free(context->shared.layers[i].image.data);
+    }
+
     glDeleteTextures(1, &context->font_texture_id);
     glDeleteTextures(1, &context->screen.texture_id);
     glDeleteFramebuffers(1, &context->screen.framebuffer);
@@ -474,91 +765,46 @@ graphics_setup_screen_vbo(struct graphics_context * const context)
 
 static
 void
-graphics_create_texture(struct graphics_image const image,
-                        GLuint * const texture_id)
+graphics_create_font_texture(struct graphics_shared const * const shared,
+                             GLuint * const texture_id)
 {
-    GLenum format = 0;
-
-    if (image.components == 3) {
-        format = GL_RGB;
-    } else if (image.components == 4) {
-        format = GL_RGBA;
-    }
-
-    if (format == 0) {
-        return;
-    }
-
-    GLint const format_internal = (GLint)format;
+    GLsizei const width = (GLsizei)shared->texture.horizontal;
+    GLsizei const height = (GLsizei)shared->texture.vertical;
 
     glGenTextures(1, texture_id);
-    glBindTexture(GL_TEXTURE_2D, *texture_id); {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, *texture_id); {
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-        glTexImage2D(GL_TEXTURE_2D,
-                     0, format_internal,
-                     image.width, image.height,
-                     0, format,
+        glTexImage3D(GL_TEXTURE_2D_ARRAY,
+                     0, GL_RGBA8,
+                     width, height, shared->layer_count,
+                     0, GL_RGBA,
                      GL_UNSIGNED_BYTE,
-                     image.data);
+                     NULL);
+
+        for (uint8_t i = 0; i < shared->layer_count; i++) {
+            struct graphics_image const image = shared->layers[i].image;
+
+            // smaller fonts occupy the lower-left corner of their layer (the
+            // image is flipped on load, so its first row is the bottom row);
+            // texture coordinates of its glyphs are calculated to match
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY,
+                            0,
+                            0, 0, i,
+                            image.width, image.height, 1,
+                            GL_RGBA,
+                            GL_UNSIGNED_BYTE,
+                            image.data);
+        }
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
-}
-
-static
-void
-graphics_set_position(struct glyph_vertex (* const verts)[GLYPH_VERTEX_COUNT],
-                      struct graphics_scale const halved_glyph)
-{
-    float const l = -halved_glyph.horizontal;
-    float const r = halved_glyph.horizontal;
-    float const b = -halved_glyph.vertical;
-    float const t = halved_glyph.vertical;
-
-    struct vector2 const bl = { .x = l, .y = b };
-    struct vector2 const tl = { .x = l, .y = t };
-    struct vector2 const tr = { .x = r, .y = t };
-    struct vector2 const br = { .x = r, .y = b };
-
-    (*verts)[0].position = (struct vector3) { .x = tl.x, .y = tl.y, .z = 0 };
-    (*verts)[1].position = (struct vector3) { .x = br.x, .y = br.y, .z = 0 };
-    (*verts)[2].position = (struct vector3) { .x = bl.x, .y = bl.y, .z = 0 };
-
-    (*verts)[3].position = (struct vector3) { .x = tl.x, .y = tl.y, .z = 0 };
-    (*verts)[4].position = (struct vector3) { .x = tr.x, .y = tr.y, .z = 0 };
-    (*verts)[5].position = (struct vector3) { .x = br.x, .y = br.y, .z = 0 };
-}
-
-static
-void
-graphics_set_uv(struct glyph_vertex (* const verts)[GLYPH_VERTEX_COUNT],
-                struct glyph_uv const uv)
-{
-    struct texture const bl = uv.min;
-    struct texture const tr = uv.max;
-
-    struct texture const tl = {
-        .u = uv.min.u,
-        .v = uv.max.v
-    };
-
-    struct texture const br = {
-        .u = uv.max.u,
-        .v = uv.min.v
-    };
-
-    (*verts)[0].texture = tl;
-    (*verts)[1].texture = br;
-    (*verts)[2].texture = bl;
-    (*verts)[3].texture = tl;
-    (*verts)[4].texture = tr;
-    (*verts)[5].texture = br;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
 }
 
+#ifndef TERM_USE_INSTANCING
 static
 void
 graphics_set_tint(struct glyph_vertex (* const verts)[GLYPH_VERTEX_COUNT],
@@ -572,6 +818,7 @@ graphics_set_tint(struct glyph_vertex (* const verts)[GLYPH_VERTEX_COUNT],
         memcpy(&(*verts)[i].color, &color, sizeof(struct color));
     }
 }
+#endif
 
 static
 void
@@ -604,29 +851,228 @@ graphics_get_transform(struct graphics_transform const transform,
     glyph->scale.y = transform.scale.vertical;
 }
 
+#ifdef TERM_USE_INSTANCING
+static
+void
+graphics_expand(struct graphics_context const * const context,
+                struct graphics_glyph const * const glyph,
+                struct glyph_instance * const instance)
+{
+#ifdef DEBUG
+    assert(sizeof(struct color) == sizeof(struct graphics_color));
+#endif
+
+    struct glyph_transform glyph_transform;
+
+    struct graphics_layer const * const layer =
+        &context->shared.layers[glyph->font];
+
+    graphics_get_transform(glyph->transform,
+                           context->viewport,
+                           layer->glyph,
+                           &glyph_transform);
+
+    glyph_transform.offset = (struct vector2) {
+        .x = layer->glyph_half.horizontal,
+        .y = layer->glyph_half.vertical
+    };
+
+    struct color color;
+
+    memcpy(&color, &glyph->color, sizeof(struct color));
+
+    glyphs_instance(glyph_transform, color, glyph->index, glyph->font,
+                    instance);
+}
+#else
+static
+void
+graphics_expand(struct graphics_context const * const context,
+                struct graphics_glyph const * const glyph,
+                struct glyph_rotation * const rotation,
+                struct glyph_vertex (* const transformed)[GLYPH_VERTEX_COUNT])
+{
+    struct graphics_layer const * const layer =
+        &context->shared.layers[glyph->font];
+
+    struct glyph_vertex vertices[GLYPH_VERTEX_COUNT];
+    struct glyph_uv const uv = layer->glyph_uvs[glyph->index];
+
+    memcpy(&vertices, layer->glyph_vertices, sizeof(layer->glyph_vertices));
+
+    glyphs_set_uvs(&vertices, uv);
+    graphics_set_tint(&vertices, glyph->color);
+
+    struct glyph_transform glyph_transform;
+
+    graphics_get_transform(glyph->transform,
+                           context->viewport,
+                           layer->glyph,
+                           &glyph_transform);
+
+    glyph_transform.offset = (struct vector2) {
+        .x = layer->glyph_half.horizontal,
+        .y = layer->glyph_half.vertical
+    };
+
+    glyphs_rotate(rotation, glyph_transform.angle);
+
+    glyphs_transform((struct glyph_vertex const (*)[GLYPH_VERTEX_COUNT])&vertices,
+                     glyph_transform,
+                     *rotation,
+                     transformed);
+}
+#endif
+
+static
+void
+graphics_expand_queue(struct graphics_context * const context)
+{
+    struct glyph_queue * const queue = context->queue;
+
+    size_t offset = 0;
+
+    // every glyph expands into the same number of vertices, so the offset
+    // of each glyph in the batch follows directly from its position in the
+    // queue; the batch may still fill up, in which case the remaining
+    // glyphs are expanded into the next batch
+    while (offset < queue->count) {
+        struct glyph_expansion expansion;
+
+        expansion.context = context;
+        expansion.queue = queue;
+        expansion.offset = offset;
+        expansion.count = glyphs_reserve(context->glyphs,
+                                         queue->count - offset,
+                                         context->font_texture_id,
+#ifdef TERM_USE_INSTANCING
+                                         &expansion.instances);
+#else
+                                         &expansion.vertices);
+#endif
+
+        if (expansion.count < MIN_GLYPHS_PER_WORKER * 2) {
+            graphics_expand_range(0, 1, &expansion);
+        } else {
+            workers_run(context->workers, graphics_expand_range, &expansion);
+        }
+
+        offset += expansion.count;
+    }
+
+    queue->count = 0;
+    queue->span_count = 0;
+    queue->glyph_count = 0;
+}
+
 static
-uint32_t
-graphics_get_table_index(uint32_t const code)
+void
+graphics_expand_range(size_t const worker,
+                      size_t const count,
+                      void * const data)
 {
-    if (code >= 33 &&
-        code <= 126) {
-        // within basic ASCII range; skip mapping
-        return code;
+    struct glyph_expansion const * const expansion =
+        (struct glyph_expansion *)data;
+
+    struct glyph_queue const * const queue = expansion->queue;
+
+    size_t const start = (expansion->count * worker) / count;
+    size_t const end = (expansion->count * (worker + 1)) / count;
+
+#ifndef TERM_USE_INSTANCING
+    struct glyph_rotation rotation = GLYPH_ROTATION_NONE;
+#endif
+
+    size_t i = start;
+    size_t span_index = graphics_find_span(queue, expansion->offset + start);
+
+    while (i < end) {
+        struct glyph_span const * const span = &queue->spans[span_index];
+        struct graphics_glyph const * const glyphs =
+            span->glyphs != NULL ? span->glyphs : &queue->glyphs[span->first];
+
+        // the glyphs of this span that fall within the range
+        size_t const first = expansion->offset + i - span->offset;
+        size_t const last = span->count - first < end - i ?
+            span->count : first + (end - i);
+
+        for (size_t n = first; n < last; n++, i++) {
+#ifdef TERM_USE_INSTANCING
+            graphics_expand(expansion->context, &glyphs[n],
+                            &expansion->instances[i]);
+#else
+            struct glyph_vertex * const vertices =
+                &expansion->vertices[i * GLYPH_VERTEX_COUNT];
+
+            graphics_expand(expansion->context, &glyphs[n], &rotation,
+                            (struct glyph_vertex (*)[GLYPH_VERTEX_COUNT])vertices);
+#endif
+        }
+
+        span_index += 1;
     }
+}
 
-    for (uint16_t i = 0; i < 33; i++) {
-        if (CP437[i] == code) {
-            return i;
+static
+size_t
+graphics_find_span(struct glyph_queue const * const queue,
+                   size_t const position)
+{
+    size_t low = 0;
+    size_t high = queue->span_count;
+
+    // spans are ordered by offset; find the last that begins at or before
+    // the position
+    while (high - low > 1) {
+        size_t const middle = low + (high - low) / 2;
+
+        if (queue->spans[middle].offset <= position) {
+            low = middle;
+        } else {
+            high = middle;
         }
     }
 
-    for (uint16_t i = 127; i < CP437_LENGTH; i++) {
-        if (CP437[i] == code) {
-            return i;
+    return low;
+}
+
+static
+void
+graphics_queue_span(struct glyph_queue * const queue,
+                    struct graphics_glyph const * const glyphs,
+                    size_t const first,
+                    size_t const count)
+{
+    if (glyphs == NULL && queue->span_count > 0) {
+        struct glyph_span * const previous =
+            &queue->spans[queue->span_count - 1];
+
+        if (previous->glyphs == NULL &&
+            previous->first + previous->count == first) {
+            // glyphs drawn one after another share a single span
+            previous->count += count;
+            queue->count += count;
+
+            return;
         }
     }
 
-    return 63; // mapping not found, default to '?'
+    if (queue->span_count == queue->span_capacity) {
+        queue->span_capacity *= 2;
+        queue->spans = realloc(queue->spans,
+                               sizeof(struct glyph_span) *
+                               queue->span_capacity);
+    }
+
+    queue->spans[queue->span_count] = (struct glyph_span) {
+        .glyphs = glyphs,
+        .first = first,
+        .count = count,
+        .offset = queue->count
+    };
+
+    queue->span_count += 1;
+    queue->count += count;
 }
 
 GLuint
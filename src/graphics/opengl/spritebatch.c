@@ -8,110 +8,143 @@
 
 #include <stdbool.h> // bool
 #include <stdlib.h> // malloc, free
-#include <stddef.h> // NULL
+#include <stdint.h> // uint8_t, uint16_t, uint32_t, int32_t
+#include <stddef.h> // size_t, NULL, offsetof
 
-#include "renderable.h" // glyph_vertex, vector3
+#include <string.h> // memcpy
+
+#include "renderable.h" // glyph_vertex, glyph_instance, glyph_uv, vector3
 
 #include <gl3w/GL/gl3w.h> // gl*, GL*
 #include <linmath/linmath.h> // mat4x4, mat4x4_*
 
-#define MAX_GLYPHS 4096 // flush when reaching this limit
+#ifdef DEBUG
+ #include <assert.h> // assert
+#endif
 
-#define GLYPH_BATCH_VERTEX_COUNT (MAX_GLYPHS * GLYPH_VERTEX_COUNT)
+#define MIN_GLYPHS 4096 // initial capacity of the batch
+
+/**
+ * The texture unit that texture coordinates of glyphs are looked up from.
+ */
+#define GLYPH_UV_UNIT 1
+
+/**
+ * The number of segments in the ring of glyph buffers.
+ *
+ * Each flush is uploaded into the next segment, so that the GPU can keep
+ * reading from the previous ones while the CPU writes.
+ */
+#define GLYPH_SEGMENT_COUNT 3
+
+#ifdef TERM_USE_INSTANCING
+ #define GLYPH_SIZE sizeof(struct glyph_instance)
+#else
+ #define GLYPH_SIZE (GLYPH_VERTEX_COUNT * sizeof(struct glyph_vertex))
+#endif
 
 struct glyph_batch {
-    struct glyph_vertex vertices[GLYPH_BATCH_VERTEX_COUNT];
+#ifdef TERM_USE_INSTANCING
+    struct glyph_instance * instances;
+#else
+    struct glyph_vertex * vertices;
+#endif
     uint32_t count;
+    uint32_t capacity;
+    /**
+     * The capacity that the batch may grow to.
+     */
+    uint32_t limit;
 };
 
 struct glyph_renderer {
     struct glyph_batch batch;
     struct renderable renderable;
     mat4x4 transform;
+    /**
+     * The buffer holding texture coordinates for every glyph of every layer,
+     * along with the buffer texture that the vertex shader reads them from.
+     */
+    GLuint uvs;
+    GLuint uv_texture;
+    /**
+     * The buffer holding indices of the corners of each quad.
+     */
+    GLuint indices;
+    /**
+     * The number of glyphs that each segment of the buffer can hold.
+     *
+     * Lags behind the capacity of the batch until the next flush.
+     */
+    uint32_t segment_capacity;
     GLuint current_texture_id;
+    /**
+     * The fence of the last draw reading from each segment, if any.
+     */
+    GLsync fences[GLYPH_SEGMENT_COUNT];
+    /**
+     * The segment that the next flush is uploaded into.
+     */
+    uint8_t segment;
 };
 
+static void glyphs_setup_program(struct glyph_renderer *);
+static void glyphs_setup_buffers(struct glyph_renderer *);
+/**
+ * Grow the batch to hold at least a number of glyphs (up to its limit).
+ */
+static void glyphs_grow(struct glyph_renderer *, size_t count);
+/**
+ * Allocate buffer storage for as many glyphs as the batch can hold.
+ */
+static void glyphs_resize_buffers(struct glyph_renderer *);
+/**
+ * Point vertex attributes at the glyphs in a segment of the buffer.
+ */
+static void glyphs_set_attributes(GLintptr offset);
+
+/**
+ * Claim the next segment of the buffer for uploading, and return its offset.
+ *
+ * If the GPU is still reading from the segment, the buffer is orphaned
+ * rather than waiting for it; the driver then hands out fresh storage,
+ * while the old storage lives on until any pending draws are done.
+ */
+static GLintptr glyphs_next_segment(struct glyph_renderer *);
+/**
+ * Delete all fences, e.g. because the buffer was orphaned.
+ */
+static void glyphs_clear_fences(struct glyph_renderer *);
+
 static void glyphs_state(bool enable);
 static bool glyphs_flush(struct glyph_renderer *);
 static void glyphs_reset(struct glyph_renderer *);
-static void glyphs_draw(struct glyph_renderer const *);
+static void glyphs_draw(struct glyph_renderer *);
 
 struct glyph_renderer *
-glyphs_init(struct viewport const viewport)
+glyphs_init(struct viewport const viewport, size_t const limit)
 {
     struct glyph_renderer * renderer = malloc(sizeof(struct glyph_renderer));
 
-    char const * const vertex_shader =
-    "#version 330 core\n"
-    "layout (location = 0) in vec3 vertex_position;\n"
-    "layout (location = 1) in vec4 vertex_color;\n"
-    "layout (location = 2) in vec2 vertex_texture_coord;\n"
-    "uniform mat4 transform;\n"
-    "out vec2 texture_coord;\n"
-    "out vec4 tint;\n"
-    "void main() {\n"
-    "    gl_Position = transform * vec4(vertex_position, 1);\n"
-    "    texture_coord = vertex_texture_coord.st;\n"
-    "    tint = vertex_color;\n"
-    "}\n";
-
-    char const * const fragment_shader =
-    "#version 330 core\n"
-    "in vec2 texture_coord;\n"
-    "in vec4 tint;\n"
-    "uniform sampler2D sampler;\n"
-    "layout (location = 0) out vec4 fragment_color;\n"
-    "void main() {\n"
-    "    fragment_color = texture(sampler, texture_coord.st) * tint;\n"
-    "}";
-
-    GLuint const vs = graphics_compile_shader(GL_VERTEX_SHADER,
-                                              vertex_shader);
-    GLuint const fs = graphics_compile_shader(GL_FRAGMENT_SHADER,
-                                              fragment_shader);
-
-    renderer->renderable.program = graphics_link_program(vs, fs);
-
-    glDeleteShader(vs);
-    glDeleteShader(fs);
-
-    glGenBuffers(1, &renderer->renderable.vbo);
-    glGenVertexArrays(1, &renderer->renderable.vao);
-
-    glBindVertexArray(renderer->renderable.vao);
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->renderable.vbo);
-
-    GLsizei const stride = sizeof(struct glyph_vertex);
-
-    glBufferData(GL_ARRAY_BUFFER,
-                 GLYPH_BATCH_VERTEX_COUNT * stride,
-                 NULL,
-                 GL_DYNAMIC_DRAW);
+    renderer->batch.count = 0;
+    renderer->batch.limit = (uint32_t)(limit > 0 ? limit : 1);
+    renderer->batch.capacity = (renderer->batch.limit < MIN_GLYPHS ?
+                                renderer->batch.limit : MIN_GLYPHS);
+#ifdef TERM_USE_INSTANCING
+    renderer->batch.instances = malloc(GLYPH_SIZE * renderer->batch.capacity);
+#else
+    renderer->batch.vertices = malloc(GLYPH_SIZE * renderer->batch.capacity);
+#endif
+    renderer->segment_capacity = 0;
 
-    glVertexAttribPointer(0,
-                          3,
-                          GL_FLOAT, GL_FALSE,
-                          stride,
-                          0);
-    glEnableVertexAttribArray(0);
+    renderer->segment = 0;
 
-    glVertexAttribPointer(1,
-                          4,
-                          GL_UNSIGNED_BYTE, GL_TRUE,
-                          stride,
-                          (GLvoid *)(sizeof(struct vector3)));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2,
-                          2,
-                          GL_UNSIGNED_SHORT, GL_TRUE,
-                          stride,
-                          (GLvoid *)(sizeof(struct vector3) +
-                                     sizeof(struct color)));
-    glEnableVertexAttribArray(2);
+    for (uint8_t i = 0; i < GLYPH_SEGMENT_COUNT; i++) {
+        renderer->fences[i] = NULL;
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    glyphs_setup_program(renderer);
+    glyphs_setup_buffers(renderer);
 
     glyphs_invalidate(renderer, viewport);
 
@@ -124,7 +157,17 @@ glyphs_release(struct glyph_renderer * const renderer)
     glDeleteProgram(renderer->renderable.program);
     glDeleteVertexArrays(1, &renderer->renderable.vao);
     glDeleteBuffers(1, &renderer->renderable.vbo);
+    glDeleteBuffers(1, &renderer->uvs);
+    glDeleteTextures(1, &renderer->uv_texture);
+    glDeleteBuffers(1, &renderer->indices);
 
+    glyphs_clear_fences(renderer);
+
+#ifdef TERM_USE_INSTANCING
+    free(renderer->batch.instances);
+#else
+    free(renderer->batch.vertices);
+#endif
     free(renderer);
 }
 
@@ -154,11 +197,19 @@ glyphs_invalidate(struct glyph_renderer * const renderer,
     glyphs_reset(renderer);
 }
 
-void
-glyphs_add(struct glyph_renderer * const renderer,
-           struct glyph_vertex (* const vertices)[GLYPH_VERTEX_COUNT],
-           struct glyph_transform const transform,
-           GLuint const texture_id)
+#ifdef TERM_USE_INSTANCING
+size_t
+glyphs_reserve(struct glyph_renderer * const renderer,
+               size_t const count,
+               GLuint const texture_id,
+               struct glyph_instance ** const instances)
+#else
+size_t
+glyphs_reserve(struct glyph_renderer * const renderer,
+               size_t const count,
+               GLuint const texture_id,
+               struct glyph_vertex ** const vertices)
+#endif
 {
     if (renderer->current_texture_id != 0 &&
         renderer->current_texture_id != texture_id) {
@@ -169,89 +220,378 @@ glyphs_add(struct glyph_renderer * const renderer,
 
     renderer->current_texture_id = texture_id;
 
-    if (renderer->batch.count + 1 > MAX_GLYPHS) {
+    if (renderer->batch.count + count > renderer->batch.capacity) {
+        // grow rather than flush, so that a frame is drawn in as few draw
+        // calls as possible
+        glyphs_grow(renderer, renderer->batch.count + count);
+    }
+
+    if (renderer->batch.count + 1 > renderer->batch.capacity) {
         if (glyphs_flush(renderer)) {
             // hitting capacity requires flushing
         }
     }
 
-    bool const requires_scaling = (transform.scale.x > 1 ||
-                                   transform.scale.x < 1 ||
-                                   transform.scale.y > 1 ||
-                                   transform.scale.y < 1);
+    size_t const available = renderer->batch.capacity - renderer->batch.count;
+    size_t const reserved = count < available ? count : available;
 
-    bool const requires_rotation = (transform.angle > 0 ||
-                                    transform.angle < 0);
+#ifdef TERM_USE_INSTANCING
+    *instances = &renderer->batch.instances[renderer->batch.count];
+#else
+    *vertices = &renderer->batch.vertices[renderer->batch.count *
+                                          GLYPH_VERTEX_COUNT];
+#endif
 
-    bool const requires_transformation = (requires_scaling ||
-                                          requires_rotation);
+    renderer->batch.count += (uint32_t)reserved;
 
-    uint32_t const vertex_offset = renderer->batch.count * GLYPH_VERTEX_COUNT;
+    return reserved;
+}
 
-    mat4x4 transformed;
+void
+glyphs_set_font(struct glyph_renderer * const renderer,
+                uint8_t const layer,
+                struct glyph_uv const (* const uvs)[GLYPH_UV_COUNT])
+{
+#ifdef DEBUG
+    assert(layer < GLYPH_LAYER_COUNT);
+#endif
+#ifdef TERM_USE_INSTANCING
+    // each glyph is a texel of 4 normalized 16-bit components in the buffer
+    // texture (min u, min v, max u, max v); exactly as held by a glyph_uv
+    GLsizeiptr const size = sizeof(struct glyph_uv) * GLYPH_UV_COUNT;
+
+    glBindBuffer(GL_TEXTURE_BUFFER, renderer->uvs);
+    glBufferSubData(GL_TEXTURE_BUFFER, size * layer, size, *uvs);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+#else
+    // texture coordinates are part of each vertex
+    (void)renderer;
+    (void)layer;
+    (void)uvs;
+#endif
+}
 
-    if (requires_transformation) {
-        mat4x4 translated;
-        mat4x4_identity(translated);
-        mat4x4_translate(translated,
-                         transform.origin.x,
-                         transform.origin.y,
-                         transform.origin.z);
+static
+void
+glyphs_setup_program(struct glyph_renderer * const renderer)
+{
+#ifdef TERM_USE_INSTANCING
+    // each glyph is drawn as an instance of 4 vertices; the quad is expanded,
+    // scaled, rotated and textured entirely in the vertex shader
+    char const * const vertex_shader =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 glyph_position;\n"
+    "layout (location = 1) in vec2 glyph_scale;\n"
+    "layout (location = 2) in float glyph_angle;\n"
+    "layout (location = 3) in uvec2 glyph_index;\n"
+    "layout (location = 4) in vec4 glyph_color;\n"
+    "uniform samplerBuffer glyph_uvs;\n"
+    "uniform mat4 transform;\n"
+    "out vec2 texture_coord;\n"
+    "flat out float layer;\n"
+    "out vec4 tint;\n"
+    "const vec2 corners[4] = vec2[4](\n"
+    "    vec2(-1, 1), vec2(1, -1), vec2(-1, -1), vec2(1, 1));\n"
+    "void main() {\n"
+    "    vec2 corner = corners[gl_VertexID];\n"
+    "    vec2 scaled = corner * glyph_scale;\n"
+    "    float s = sin(glyph_angle);\n"
+    "    float c = cos(glyph_angle);\n"
+    "    vec2 rotated = vec2(c * scaled.x - s * scaled.y,\n"
+    "                        s * scaled.x + c * scaled.y);\n"
+    "    vec3 position = vec3(glyph_position.xy + rotated, glyph_position.z);\n"
+    "    gl_Position = transform * vec4(position, 1);\n"
+    "    vec4 uv = texelFetch(glyph_uvs,\n"
+    "                         int(glyph_index.y * 256u + glyph_index.x));\n"
+    "    texture_coord = vec2(corner.x < 0 ? uv.x : uv.z,\n"
+    "                         corner.y < 0 ? uv.y : uv.w);\n"
+    "    layer = float(glyph_index.y);\n"
+    "    tint = glyph_color;\n"
+    "}\n";
+#else
+    char const * const vertex_shader =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 vertex_position;\n"
+    "layout (location = 1) in vec4 vertex_color;\n"
+    "layout (location = 2) in vec2 vertex_texture_coord;\n"
+    "layout (location = 3) in float vertex_layer;\n"
+    "uniform mat4 transform;\n"
+    "out vec2 texture_coord;\n"
+    "flat out float layer;\n"
+    "out vec4 tint;\n"
+    "void main() {\n"
+    "    gl_Position = transform * vec4(vertex_position, 1);\n"
+    "    texture_coord = vertex_texture_coord.st;\n"
+    "    layer = vertex_layer;\n"
+    "    tint = vertex_color;\n"
+    "}\n";
+#endif
+
+    char const * const fragment_shader =
+    "#version 330 core\n"
+    "in vec2 texture_coord;\n"
+    "flat in float layer;\n"
+    "in vec4 tint;\n"
+    "uniform sampler2DArray sampler;\n"
+    "layout (location = 0) out vec4 fragment_color;\n"
+    "void main() {\n"
+    "    fragment_color = texture(sampler, vec3(texture_coord.st, layer)) *\n"
+    "                     tint;\n"
+    "}";
 
-        mat4x4 rotated;
-        mat4x4_identity(rotated);
+    GLuint const vs = graphics_compile_shader(GL_VERTEX_SHADER,
+                                              vertex_shader);
+    GLuint const fs = graphics_compile_shader(GL_FRAGMENT_SHADER,
+                                              fragment_shader);
 
-        if (requires_rotation) {
-            mat4x4_rotate_Z(rotated, rotated,
-                            transform.angle);
-        }
+    renderer->renderable.program = graphics_link_program(vs, fs);
 
-        mat4x4 scaled;
-        mat4x4_identity(scaled);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
 
-        if (requires_scaling) {
-            mat4x4_scale_aniso(scaled, scaled,
-                               transform.scale.x,
-                               transform.scale.y,
-                               1);
-        }
+    GLuint const program = renderer->renderable.program;
 
-        mat4x4_mul(transformed, translated, rotated);
-        mat4x4_mul(transformed, transformed, scaled);
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "sampler"), 0);
+#ifdef TERM_USE_INSTANCING
+    glUniform1i(glGetUniformLocation(program, "glyph_uvs"), GLYPH_UV_UNIT);
+#endif
+    glUseProgram(0);
+}
+
+static
+void
+glyphs_setup_buffers(struct glyph_renderer * const renderer)
+{
+    glGenBuffers(1, &renderer->renderable.vbo);
+    glGenVertexArrays(1, &renderer->renderable.vao);
+
+    glBindVertexArray(renderer->renderable.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->renderable.vbo);
+
+    // the index buffer is part of the vertex array state
+    glGenBuffers(1, &renderer->indices);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer->indices);
+
+    glyphs_resize_buffers(renderer);
+
+    glyphs_set_attributes(0);
+
+#ifdef TERM_USE_INSTANCING
+    for (GLuint attribute = 0; attribute < 5; attribute++) {
+        glEnableVertexAttribArray(attribute);
+        // advance once per glyph, rather than once per vertex
+        glVertexAttribDivisor(attribute, 1);
+    }
+
+    glGenBuffers(1, &renderer->uvs);
+    glBindBuffer(GL_TEXTURE_BUFFER, renderer->uvs);
+    glBufferData(GL_TEXTURE_BUFFER,
+                 sizeof(struct glyph_uv) * GLYPH_UV_COUNT * GLYPH_LAYER_COUNT,
+                 NULL,
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    glGenTextures(1, &renderer->uv_texture);
+    glBindTexture(GL_TEXTURE_BUFFER, renderer->uv_texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA16, renderer->uvs);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+#else
+    for (GLuint attribute = 0; attribute < 4; attribute++) {
+        glEnableVertexAttribArray(attribute);
     }
 
-    for (uint16_t i = 0; i < GLYPH_VERTEX_COUNT; i++) {
-        struct glyph_vertex vertex = (*vertices)[i];
+    // texture coordinates are part of each vertex
+    renderer->uvs = 0;
+    renderer->uv_texture = 0;
+#endif
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+static
+void
+glyphs_grow(struct glyph_renderer * const renderer, size_t const count)
+{
+    uint32_t capacity = renderer->batch.capacity;
+
+    while (capacity < count && capacity < renderer->batch.limit) {
+        capacity *= 2;
+    }
+
+    if (capacity > renderer->batch.limit) {
+        capacity = renderer->batch.limit;
+    }
+
+    if (capacity == renderer->batch.capacity) {
+        return;
+    }
+
+    renderer->batch.capacity = capacity;
+
+    // buffer storage is resized on the next flush
+#ifdef TERM_USE_INSTANCING
+    renderer->batch.instances = realloc(renderer->batch.instances,
+                                        GLYPH_SIZE * capacity);
+#else
+    renderer->batch.vertices = realloc(renderer->batch.vertices,
+                                       GLYPH_SIZE * capacity);
+#endif
+}
+
+static
+void
+glyphs_resize_buffers(struct glyph_renderer * const renderer)
+{
+    uint32_t const capacity = renderer->batch.capacity;
+
+    // any pending draws keep reading from the old storage
+    glBufferData(GL_ARRAY_BUFFER,
+                 (GLsizeiptr)(GLYPH_SIZE * capacity * GLYPH_SEGMENT_COUNT),
+                 NULL,
+                 GL_STREAM_DRAW);
+
+    glyphs_clear_fences(renderer);
+
+#ifdef TERM_USE_INSTANCING
+    // every instance is drawn using the same indices
+    uint32_t const quads = 1;
+#else
+    uint32_t const quads = capacity;
+#endif
+
+    GLsizeiptr const size = sizeof(uint32_t) * GLYPH_INDEX_COUNT * quads;
+
+    uint32_t * const indices = malloc((size_t)size);
+
+    glyphs_index(indices, quads);
+
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indices, GL_STATIC_DRAW);
+
+    free(indices);
+
+    renderer->segment_capacity = capacity;
+}
+
+static
+void
+glyphs_set_attributes(GLintptr const offset)
+{
+#ifdef TERM_USE_INSTANCING
+    GLsizei const stride = sizeof(struct glyph_instance);
+
+    glVertexAttribPointer(0,
+                          3,
+                          GL_FLOAT, GL_FALSE,
+                          stride,
+                          (GLvoid *)(offset +
+                                     offsetof(struct glyph_instance, position)));
+    glVertexAttribPointer(1,
+                          2,
+                          GL_HALF_FLOAT, GL_FALSE,
+                          stride,
+                          (GLvoid *)(offset +
+                                     offsetof(struct glyph_instance, scale)));
+    glVertexAttribPointer(2,
+                          1,
+                          GL_HALF_FLOAT, GL_FALSE,
+                          stride,
+                          (GLvoid *)(offset +
+                                     offsetof(struct glyph_instance, angle)));
+    // index and layer
+    glVertexAttribIPointer(3,
+                           2,
+                           GL_UNSIGNED_BYTE,
+                           stride,
+                           (GLvoid *)(offset +
+                                      offsetof(struct glyph_instance, index)));
+    glVertexAttribPointer(4,
+                          4,
+                          GL_UNSIGNED_BYTE, GL_TRUE,
+                          stride,
+                          (GLvoid *)(offset +
+                                     offsetof(struct glyph_instance, color)));
+#else
+    GLsizei const stride = sizeof(struct glyph_vertex);
+
+    glVertexAttribPointer(0,
+                          3,
+                          GL_FLOAT, GL_FALSE,
+                          stride,
+                          (GLvoid *)(offset));
+    glVertexAttribPointer(1,
+                          4,
+                          GL_UNSIGNED_BYTE, GL_TRUE,
+                          stride,
+                          (GLvoid *)(offset +
+                                     sizeof(struct vector3)));
+    glVertexAttribPointer(2,
+                          2,
+                          GL_UNSIGNED_SHORT, GL_TRUE,
+                          stride,
+                          (GLvoid *)(offset +
+                                     sizeof(struct vector3) +
+                                     sizeof(struct color)));
+    glVertexAttribPointer(3,
+                          1,
+                          GL_UNSIGNED_BYTE, GL_FALSE,
+                          stride,
+                          (GLvoid *)(offset +
+                                     offsetof(struct glyph_vertex, layer)));
+#endif
+}
 
-        if (requires_transformation) {
-            vec4 position = {
-                vertex.position.x,
-                vertex.position.y,
-                vertex.position.z,
-                1
-            };
+static
+GLintptr
+glyphs_next_segment(struct glyph_renderer * const renderer)
+{
+    uint8_t const segment = renderer->segment;
 
-            vec4 world_position;
+    renderer->segment = (segment + 1) % GLYPH_SEGMENT_COUNT;
 
-            mat4x4_mul_vec4(world_position, transformed, position);
+    GLsync const fence = renderer->fences[segment];
 
-            vertex.position = (struct vector3) {
-                world_position[0] + transform.offset.x,
-                world_position[1] + transform.offset.y,
-                world_position[2]
-            };
+    if (fence != NULL) {
+#ifdef TERM_INCLUDE_PROFILER
+        profiler_begin_fence_wait();
+#endif
+        // only poll the fence; never block waiting for it
+        GLenum const status = glClientWaitSync(fence, 0, 0);
+#ifdef TERM_INCLUDE_PROFILER
+        profiler_end_fence_wait();
+#endif
+        if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+            // the segment is still in use; orphan the buffer instead
+            glBufferData(GL_ARRAY_BUFFER,
+                         (GLsizeiptr)(GLYPH_SIZE *
+                                      renderer->segment_capacity *
+                                      GLYPH_SEGMENT_COUNT),
+                         NULL,
+                         GL_STREAM_DRAW);
+
+            glyphs_clear_fences(renderer);
         } else {
-            vertex.position = (struct vector3) {
-                vertex.position.x + transform.origin.x + transform.offset.x,
-                vertex.position.y + transform.origin.y + transform.offset.y,
-                vertex.position.z + transform.origin.z
-            };
-        }
+            glDeleteSync(fence);
 
-        renderer->batch.vertices[vertex_offset + i] = vertex;
+            renderer->fences[segment] = NULL;
+        }
     }
 
-    renderer->batch.count += 1;
+    return (GLintptr)(GLYPH_SIZE * renderer->segment_capacity * segment);
+}
+
+static
+void
+glyphs_clear_fences(struct glyph_renderer * const renderer)
+{
+    for (uint8_t i = 0; i < GLYPH_SEGMENT_COUNT; i++) {
+        if (renderer->fences[i] != NULL) {
+            glDeleteSync(renderer->fences[i]);
+
+            renderer->fences[i] = NULL;
+        }
+    }
 }
 
 static
@@ -288,8 +628,13 @@ glyphs_begin(struct glyph_renderer const * const renderer)
     glGetUniformLocation(renderer->renderable.program, "transform");
     glUniformMatrix4fv(uniform_transform, 1, GL_FALSE, *renderer->transform);
 
+#ifdef TERM_USE_INSTANCING
+    glActiveTexture(GL_TEXTURE0 + GLYPH_UV_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, renderer->uv_texture);
+#endif
+
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, renderer->current_texture_id);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, renderer->current_texture_id);
     glBindVertexArray(renderer->renderable.vao);
     glBindBuffer(GL_ARRAY_BUFFER, renderer->renderable.vbo);
 }
@@ -301,7 +646,12 @@ glyphs_end(struct glyph_renderer * const renderer)
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+#ifdef TERM_USE_INSTANCING
+    glActiveTexture(GL_TEXTURE0 + GLYPH_UV_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+#endif
     glUseProgram(0);
 
     glyphs_state(false);
@@ -330,18 +680,63 @@ glyphs_state(bool const enable)
 
 static
 void
-glyphs_draw(struct glyph_renderer const * const renderer)
+glyphs_draw(struct glyph_renderer * const renderer)
 {
-    uint32_t const count = renderer->batch.count * GLYPH_VERTEX_COUNT;
+#ifdef TERM_USE_INSTANCING
+    uint32_t const count = renderer->batch.count;
 
-    GLsizeiptr const size = sizeof(struct glyph_vertex) * count;
+    GLsizeiptr const size = sizeof(struct glyph_instance) * count;
 
-    glBufferSubData(GL_ARRAY_BUFFER,
-                    0,
-                    size,
-                    renderer->batch.vertices);
+    void const * const data = renderer->batch.instances;
+#else
+    uint32_t const count = renderer->batch.count;
+
+    GLsizeiptr const size = sizeof(struct glyph_vertex) *
+                            GLYPH_VERTEX_COUNT * count;
+
+    void const * const data = renderer->batch.vertices;
+#endif
+    if (renderer->segment_capacity < renderer->batch.capacity) {
+        // the batch has grown since the last flush
+        glyphs_resize_buffers(renderer);
+    }
+
+    uint8_t const segment = renderer->segment;
+
+    GLintptr const offset = glyphs_next_segment(renderer);
+
+    // the segment is not in use by the GPU, so there is no need for the
+    // driver to synchronize with any pending draws
+    void * const mapped = glMapBufferRange(GL_ARRAY_BUFFER,
+                                           offset,
+                                           size,
+                                           GL_MAP_WRITE_BIT |
+                                           GL_MAP_INVALIDATE_RANGE_BIT |
+                                           GL_MAP_UNSYNCHRONIZED_BIT);
+
+    if (mapped != NULL) {
+        memcpy(mapped, data, (size_t)size);
+
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    }
+
+    glyphs_set_attributes(offset);
+
+    // every font is a layer of the same texture array, so this rarely changes
+    glBindTexture(GL_TEXTURE_2D_ARRAY, renderer->current_texture_id);
+
+#ifdef TERM_USE_INSTANCING
+    glDrawElementsInstanced(GL_TRIANGLES, GLYPH_INDEX_COUNT,
+                            GL_UNSIGNED_INT, NULL,
+                            (GLsizei)count);
+#else
+    glDrawElements(GL_TRIANGLES, (GLsizei)(GLYPH_INDEX_COUNT * count),
+                   GL_UNSIGNED_INT, NULL);
+#endif
 
-    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)count);
+    renderer->fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 #ifdef TERM_INCLUDE_PROFILER
     profiler_increment_draw_count(1);
 #endif
@@ -1,26 +1,70 @@
 #pragma once
 
-#include "renderable.h" // glyph_vertex :completeness
+#include "renderable.h" // glyph_vertex, glyph_instance :completeness
+#include "quad.h" // GLYPH_VERTEX_COUNT, glyph_transform, glyph_rotation, glyphs_*
 
-#define GLYPH_VERTEX_COUNT (2 * 3) // 2 triangles per quad = 6 vertices
+#include <stdint.h> // uint8_t
+#include <stddef.h> // size_t
+
+#define GLYPH_UV_COUNT 256 // one for each glyph in a codepage
+#define GLYPH_LAYER_COUNT 16 // one for each font
 
 struct glyph_renderer;
 struct viewport;
 
-struct glyph_transform {
-    struct vector3 origin;
-    struct vector2 offset;
-    struct vector2 scale;
-    float angle;
-};
-
-struct glyph_renderer * glyphs_init(struct viewport);
+/**
+ * Create a glyph renderer.
+ *
+ * The batch starts out small and grows to hold as many glyphs as are drawn
+ * during a frame, but never beyond the limit; if it is full, glyphs are
+ * flushed instead.
+ */
+struct glyph_renderer * glyphs_init(struct viewport, size_t limit);
 void glyphs_release(struct glyph_renderer *);
 
-void glyphs_add(struct glyph_renderer *,
-                struct glyph_vertex (* vertices)[GLYPH_VERTEX_COUNT],
-                struct glyph_transform,
-                GLuint texture_id);
+#ifdef TERM_USE_INSTANCING
+/**
+ * Reserve room for a number of glyphs in the current batch.
+ *
+ * The batch is flushed first if it is either full, or holding glyphs of
+ * another texture.
+ *
+ * Return the number of glyphs reserved, which may be fewer than requested if
+ * the batch can not hold them all, and point to the first one. Reserved
+ * glyphs must be written (e.g. using `glyphs_instance`) before the batch is
+ * flushed.
+ */
+size_t glyphs_reserve(struct glyph_renderer *,
+                      size_t count,
+                      GLuint texture_id,
+                      struct glyph_instance ** instances);
+#else
+/**
+ * Reserve room for a number of glyphs in the current batch.
+ *
+ * The batch is flushed first if it is either full, or holding glyphs of
+ * another texture.
+ *
+ * Return the number of glyphs reserved, which may be fewer than requested if
+ * the batch can not hold them all, and point to their first vertex. Reserved
+ * vertices must be written (e.g. using `glyphs_transform`) before the batch
+ * is flushed.
+ */
+size_t glyphs_reserve(struct glyph_renderer *,
+                      size_t count,
+                      GLuint texture_id,
+                      struct glyph_vertex ** vertices);
+#endif
+
+/**
+ * Set the texture coordinates of every glyph in the font held by a layer of
+ * the texture array.
+ *
+ * Only needed when glyphs are expanded into quads by the vertex shader.
+ */
+void glyphs_set_font(struct glyph_renderer *,
+                     uint8_t layer,
+                     struct glyph_uv const (* uvs)[GLYPH_UV_COUNT]);
 
 void glyphs_invalidate(struct glyph_renderer *, struct viewport);
 
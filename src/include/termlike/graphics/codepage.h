@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h> // uint8_t, uint16_t, uint32_t
+#include <stddef.h> // size_t
+
+/**
+ * The index that marks a linebreak in a string of glyph indices.
+ *
+ * The first glyph of the codepage (NUL) is never printed, and can never occur
+ * in a printed string either, so its index is free to mark linebreaks.
+ */
+#define CODEPAGE_LINEBREAK 0
+/**
+ * The index of a whitespace in a string of glyph indices.
+ */
+#define CODEPAGE_SPACE 32
+/**
+ * The index of the glyph used for characters that are not in the codepage.
+ */
+#define CODEPAGE_UNKNOWN 63 // '?'
+
+/**
+ * The highest possible codepoint.
+ */
+#define CODEPAGE_MAX_CODE 0x10FFFF
+/**
+ * The number of codepoints covered by each page of a codepage.
+ */
+#define CODEPAGE_PAGE_SIZE 256
+/**
+ * The number of pages needed to cover every possible codepoint.
+ */
+#define CODEPAGE_PAGE_COUNT ((CODEPAGE_MAX_CODE + 1) / CODEPAGE_PAGE_SIZE)
+
+/**
+ * Represents a mapping from codepoints to indices of glyphs in a font.
+ *
+ * The mapping is a two-level table: codepoints are split into pages of 256,
+ * and each page that holds at least one mapped codepoint has a table of glyph
+ * indices. Every other page refers to a shared table where every codepoint
+ * maps to `CODEPAGE_UNKNOWN`. This makes looking up any codepoint a matter of
+ * two reads, while only taking up memory for the pages actually in use
+ * (e.g. for CP437, 10 tables of 256 bytes) along with a directory of pages
+ * (8KB).
+ */
+struct codepage {
+    /**
+     * The tables of glyph indices for each page in use.
+     *
+     * The first table is shared by all pages not in use.
+     */
+    uint8_t * tables;
+    /**
+     * The table of each page.
+     */
+    uint16_t directory[CODEPAGE_PAGE_COUNT];
+    size_t table_count;
+};
+
+/**
+ * Create a codepage from a table of codepoints, indexed by glyph.
+ *
+ * If a codepoint is repeated in the table, the lowest glyph index is used.
+ */
+struct codepage * codepage_init(uint32_t const * codes, size_t count);
+void codepage_release(struct codepage *);
+
+/**
+ * Return the index of the glyph representing a character in the codepage.
+ *
+ * Characters that are not represented in the codepage are mapped to
+ * `CODEPAGE_UNKNOWN`.
+ */
+inline
+uint8_t
+codepage_index(struct codepage const * const codepage, uint32_t const code)
+{
+    if (code > CODEPAGE_MAX_CODE) {
+        return CODEPAGE_UNKNOWN;
+    }
+
+    uint16_t const table = codepage->directory[code / CODEPAGE_PAGE_SIZE];
+
+    return codepage->tables[(table * CODEPAGE_PAGE_SIZE) +
+                            (code % CODEPAGE_PAGE_SIZE)];
+}
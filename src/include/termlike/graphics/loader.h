@@ -5,8 +5,15 @@
 
 struct graphics_image;
 
-typedef void image_loaded_callback(struct graphics_image);
+/**
+ * Represents a function invoked when an image has been loaded.
+ *
+ * Functions that require stateful callbacks can provide a generic void pointer
+ * that will be passed along with the image.
+ */
+typedef void image_loaded_callback(struct graphics_image, void *);
 
 bool load_image_data(uint8_t const * buffer,
                      int32_t length,
-                     image_loaded_callback *);
+                     image_loaded_callback *,
+                     void * data);
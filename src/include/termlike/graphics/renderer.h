@@ -1,6 +1,8 @@
 #pragma once
 
 #include <stdint.h> // uint8_t, int32_t
+#include <stddef.h> // size_t
+#include <stdbool.h> // bool
 
 struct graphics_image {
     uint8_t * data;
@@ -34,10 +36,38 @@ struct graphics_transform {
     float angle;
 };
 
+/**
+ * Represents a glyph that has been laid out and is ready to be drawn.
+ */
+struct graphics_glyph {
+    struct graphics_transform transform;
+    struct graphics_color color;
+    /**
+     * The index of the glyph in the codepage (see codepage.h).
+     */
+    uint8_t index;
+    /**
+     * The font that the glyph is drawn from (see `graphics_add_font`).
+     */
+    uint8_t font;
+};
+
 struct graphics_context;
 struct viewport;
 
-struct graphics_context * graphics_init(struct viewport);
+/**
+ * Create a graphics context.
+ *
+ * If using more than one thread, drawn glyphs are queued up and expanded into
+ * vertices in parallel when ending a frame, rather than one by one as they are
+ * drawn. Either way, the resulting vertices are identical.
+ *
+ * Glyphs are drawn in batches of up to the maximum number of glyphs; ideally
+ * a single batch per frame.
+ */
+struct graphics_context * graphics_init(struct viewport,
+                                        size_t threads,
+                                        size_t max_glyphs);
 
 void graphics_release(struct graphics_context *);
 
@@ -47,13 +77,34 @@ void graphics_end(struct graphics_context *);
 void graphics_draw(struct graphics_context const *,
                    struct graphics_color,
                    struct graphics_transform,
-                   uint32_t code);
+                   uint8_t index,
+                   uint8_t font);
+/**
+ * Draw a set of glyphs.
+ *
+ * When expanding on more than one thread, the glyphs are not expanded (nor
+ * copied) until the end of the frame, so they must remain valid until then.
+ */
+void graphics_draw_glyphs(struct graphics_context const *,
+                          struct graphics_glyph const *,
+                          size_t count);
 
 void graphics_get_font(struct graphics_context const *,
+                       uint8_t id,
                        struct graphics_font *);
-void graphics_set_font(struct graphics_context *,
+/**
+ * Add a font, and set the id that glyphs refer to it by.
+ *
+ * All fonts are held by a single texture array (one font per layer), so
+ * glyphs can be drawn from any mix of fonts without breaking a batch.
+ *
+ * Return false if no more fonts can be added, or if the image is not exactly
+ * the size of the grid of glyphs that the font describes.
+ */
+bool graphics_add_font(struct graphics_context *,
                        struct graphics_image,
-                       struct graphics_font);
+                       struct graphics_font,
+                       uint8_t * id);
 
 void graphics_invalidate(struct graphics_context *, struct viewport);
 
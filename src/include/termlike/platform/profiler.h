@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdint.h> // uint8_t, uint16_t
+#include <stddef.h> // size_t
 
 struct profiler_stats {
     double frame_time;
@@ -8,6 +9,14 @@ struct profiler_stats {
     uint16_t frames_per_second_min;
     uint16_t frames_per_second_max;
     uint16_t draw_count;
+    size_t cache_hits;
+    size_t cache_misses;
+    size_t arena_peak;
+    /**
+     * The time spent checking whether the GPU is done with glyph buffers
+     * during the last frame (in milliseconds).
+     */
+    double fence_wait;
 };
 
 void profiler_reset(void);
@@ -19,5 +28,10 @@ void profiler_sum(struct profiler_stats, float load);
 
 void profiler_draw(void);
 void profiler_increment_draw_count(uint8_t amount);
+void profiler_set_cache_usage(size_t hits, size_t misses);
+void profiler_set_arena_usage(size_t peak);
+
+void profiler_begin_fence_wait(void);
+void profiler_end_fence_wait(void);
 
 struct profiler_stats profiler_stats(void);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h> // size_t
+
+struct workers;
+
+/**
+ * Represents a function invoked on each worker thread.
+ *
+ * Each invocation is passed the index of the worker it runs on, along with the
+ * total number of workers, so that work can be split into disjoint ranges.
+ */
+typedef void workers_callback(size_t worker, size_t count, void *);
+
+/**
+ * Create a pool of workers.
+ *
+ * The calling thread counts as the first worker; i.e. a pool of 4 workers
+ * starts 3 additional threads, and a pool of 1 worker starts none.
+ */
+struct workers * workers_init(size_t count);
+void workers_release(struct workers *);
+
+size_t workers_count(struct workers const *);
+
+/**
+ * Invoke a function on every worker, including the calling thread.
+ *
+ * Return when all workers have finished.
+ */
+void workers_run(struct workers *, workers_callback *, void *);
@@ -0,0 +1,214 @@
+#include "intern.h" // intern_table, intern_*
+
+#include <stdlib.h> // malloc, realloc, free
+#include <stdint.h> // uint8_t, uint32_t, uint64_t, UINT32_MAX
+#include <stddef.h> // size_t
+
+#include <string.h> // memcmp, memcpy
+
+#ifdef DEBUG
+ #include <assert.h> // assert
+#endif
+
+/**
+ * Represents an empty slot in the hash table.
+ */
+#define INTERN_NONE UINT32_MAX
+
+/**
+ * The offset basis of the FNV-1a hash function.
+ */
+#define HASH_OFFSET 0xcbf29ce484222325ULL
+/**
+ * The prime of the FNV-1a hash function.
+ */
+#define HASH_PRIME 0x100000001b3ULL
+
+struct intern_table {
+    /**
+     * The distinct values, ordered by id.
+     */
+    uint8_t * values;
+    /**
+     * An open-addressed hash table of ids.
+     */
+    uint32_t * slots;
+    size_t size;
+    size_t count;
+    size_t capacity;
+    size_t slot_count;
+    /**
+     * The id of the most recently added value.
+     *
+     * Values are typically added in runs of identical values (e.g. many prints
+     * in a row using the same transformation), so this is checked first.
+     */
+    uint32_t last;
+};
+
+static uint64_t intern_hash(void const * value, size_t size);
+static uint32_t * intern_find(struct intern_table const *,
+                              void const * value,
+                              uint64_t hash);
+static void intern_grow(struct intern_table *);
+
+struct intern_table *
+intern_init(size_t const size)
+{
+    struct intern_table * const table = malloc(sizeof(struct intern_table));
+
+    table->size = size;
+    table->count = 0;
+    table->capacity = 16; // default 16 values, expands when needed
+    table->values = malloc(size * table->capacity);
+
+    // keep at most 50% load on slots
+    table->slot_count = table->capacity * 2;
+    table->slots = malloc(sizeof(uint32_t) * table->slot_count);
+
+    for (size_t i = 0; i < table->slot_count; i++) {
+        table->slots[i] = INTERN_NONE;
+    }
+
+    table->last = INTERN_NONE;
+
+    return table;
+}
+
+void
+intern_release(struct intern_table * const table)
+{
+    free(table->values);
+    free(table->slots);
+    free(table);
+}
+
+uint32_t
+intern_add(struct intern_table * const table, void const * const value)
+{
+    if (table->last != INTERN_NONE &&
+        memcmp(intern_get(table, table->last), value, table->size) == 0) {
+        return table->last;
+    }
+
+    uint64_t const hash = intern_hash(value, table->size);
+
+    uint32_t * slot = intern_find(table, value, hash);
+
+    if (*slot == INTERN_NONE) {
+        if (table->count == table->capacity) {
+            intern_grow(table);
+
+            // slots have been redistributed
+            slot = intern_find(table, value, hash);
+        }
+#ifdef DEBUG
+        assert(table->count < INTERN_NONE /* ran out of ids */);
+#endif
+        uint32_t const id = (uint32_t)table->count;
+
+        memcpy(table->values + (table->size * id), value, table->size);
+
+        table->count += 1;
+
+        *slot = id;
+    }
+
+    table->last = *slot;
+
+    return *slot;
+}
+
+void const *
+intern_get(struct intern_table const * const table, uint32_t const id)
+{
+#ifdef DEBUG
+    assert(id < table->count /* id out of range */);
+#endif
+    return table->values + (table->size * id);
+}
+
+size_t
+intern_count(struct intern_table const * const table)
+{
+    return table->count;
+}
+
+void
+intern_reset(struct intern_table * const table)
+{
+    if (table->count == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < table->slot_count; i++) {
+        table->slots[i] = INTERN_NONE;
+    }
+
+    table->count = 0;
+    table->last = INTERN_NONE;
+}
+
+static
+uint64_t
+intern_hash(void const * const value, size_t const size)
+{
+    uint8_t const * const bytes = (uint8_t const *)value;
+
+    uint64_t hash = HASH_OFFSET;
+
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= HASH_PRIME;
+    }
+
+    return hash;
+}
+
+static
+uint32_t *
+intern_find(struct intern_table const * const table,
+            void const * const value,
+            uint64_t const hash)
+{
+    size_t const mask = table->slot_count - 1;
+
+    size_t i = hash & mask;
+
+    // probe linearly until finding either the value or an empty slot
+    while (table->slots[i] != INTERN_NONE) {
+        void const * const other = intern_get(table, table->slots[i]);
+
+        if (memcmp(other, value, table->size) == 0) {
+            break;
+        }
+
+        i = (i + 1) & mask;
+    }
+
+    return &table->slots[i];
+}
+
+static
+void
+intern_grow(struct intern_table * const table)
+{
+    table->capacity *= 2;
+    table->values = realloc(table->values, table->size * table->capacity);
+
+    table->slot_count = table->capacity * 2;
+    table->slots = realloc(table->slots, sizeof(uint32_t) * table->slot_count);
+
+    for (size_t i = 0; i < table->slot_count; i++) {
+        table->slots[i] = INTERN_NONE;
+    }
+
+    for (uint32_t id = 0; id < table->count; id++) {
+        void const * const value = intern_get(table, id);
+
+        uint32_t * const slot = intern_find(table, value,
+                                            intern_hash(value, table->size));
+
+        *slot = id;
+    }
+}
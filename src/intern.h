@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h> // uint32_t
+#include <stddef.h> // size_t
+
+struct intern_table;
+
+/**
+ * Create a table of distinct values, each of a fixed size (in bytes).
+ *
+ * Values are compared bytewise, so they must not hold any padding.
+ */
+struct intern_table * intern_init(size_t size);
+void intern_release(struct intern_table *);
+
+/**
+ * Add a value to a table, unless an identical value is already held.
+ *
+ * Return the id of the value; identical values always share the same id.
+ */
+uint32_t intern_add(struct intern_table *, void const * value);
+/**
+ * Return the value corresponding to an id.
+ */
+void const * intern_get(struct intern_table const *, uint32_t id);
+
+/**
+ * Return the number of distinct values held.
+ */
+size_t intern_count(struct intern_table const *);
+
+/**
+ * Remove all values from a table.
+ *
+ * Memory is retained, so that the table can be reused without allocating.
+ */
+void intern_reset(struct intern_table *);
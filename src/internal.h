@@ -1,9 +1,16 @@
 #pragma once
 
 #include <termlike/config.h> // term_settings :completeness
+#include <termlike/bounds.h> // term_bounds :completeness
+
+#include <stddef.h> // size_t
 
 struct term_layer;
 struct term_anchor;
+struct term_text;
+
+struct codepage;
+struct layout;
 
 struct window_size;
 struct window_params;
@@ -17,3 +24,19 @@ void rotate_point_center(struct term_anchor point,
 void term_get_display_params(struct term_settings,
                              struct window_size,
                              struct window_params *);
+
+/**
+ * Return the layout of an editable text within bounds, with each character
+ * taking up the given dimensions (in pixels), and at most limit characters on
+ * each line (if not zero).
+ *
+ * Only paragraphs that were edited since the last layout (or all of them, if
+ * anything else differs) are decoded and wrapped again. If nothing differs at
+ * all, the previous layout is returned as-is.
+ */
+struct layout const * term_layout_text(struct term_text *,
+                                       struct codepage const *,
+                                       struct term_bounds,
+                                       size_t limit,
+                                       float width,
+                                       float height);
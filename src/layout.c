@@ -0,0 +1,159 @@
+#include "layout.h" // layout, layout_glyph, layout_*
+
+#include <termlike/bounds.h> // term_bounds, TERM_BOUNDS_UNBOUNDED
+#include <termlike/graphics/codepage.h> // CODEPAGE_SPACE
+
+#include <stdlib.h> // malloc, realloc, free
+#include <stdint.h> // uint8_t, uint32_t, int32_t
+#include <stddef.h> // size_t
+
+#include <math.h> // floorf
+
+#include "buffer.h" // buffer, buffer_foreach_line
+
+/**
+ * Provides values for laying out the lines of a buffer.
+ */
+struct layout_state {
+    struct layout * layout;
+    struct term_bounds bounds;
+    /**
+     * The number of lines in the layout prior to this buffer.
+     */
+    uint32_t first_line;
+    /**
+     * The dimensions (in pixels) of a character.
+     */
+    float width, height;
+};
+
+static void layout_line(uint8_t const * indices,
+                        size_t count,
+                        uint32_t line,
+                        void *);
+
+void
+layout_init(struct layout * const layout)
+{
+    layout->glyph_count = 0;
+    layout->glyph_capacity = 16; // default 16 glyphs, expands when needed
+    layout->glyphs = malloc(sizeof(struct layout_glyph) *
+                            layout->glyph_capacity);
+
+    layout->line_count = 0;
+    layout->line_capacity = 4; // default 4 lines, expands when needed
+    layout->line_widths = malloc(sizeof(int32_t) * layout->line_capacity);
+
+    layout->size.width = 0;
+    layout->size.height = 0;
+}
+
+void
+layout_release(struct layout * const layout)
+{
+    free(layout->glyphs);
+    free(layout->line_widths);
+}
+
+void
+layout_clear(struct layout * const layout)
+{
+    layout->glyph_count = 0;
+    layout->line_count = 0;
+
+    layout->size.width = 0;
+    layout->size.height = 0;
+}
+
+void
+layout_add_glyph(struct layout * const layout,
+                 struct layout_glyph const glyph)
+{
+    if (layout->glyph_count == layout->glyph_capacity) {
+        layout->glyph_capacity *= 2;
+        layout->glyphs = realloc(layout->glyphs,
+                                 sizeof(struct layout_glyph) *
+                                 layout->glyph_capacity);
+    }
+
+    layout->glyphs[layout->glyph_count] = glyph;
+    layout->glyph_count += 1;
+}
+
+void
+layout_add_line(struct layout * const layout, int32_t const width)
+{
+    if (layout->line_count == layout->line_capacity) {
+        layout->line_capacity *= 2;
+        layout->line_widths = realloc(layout->line_widths,
+                                      sizeof(int32_t) * layout->line_capacity);
+    }
+
+    layout->line_widths[layout->line_count] = width;
+    layout->line_count += 1;
+
+    if (layout->size.width < width) {
+        layout->size.width = width;
+    }
+}
+
+void
+layout_buffer(struct layout * const layout,
+              struct buffer const * const buffer,
+              struct term_bounds const bounds,
+              float const width,
+              float const height)
+{
+    struct layout_state state;
+
+    state.layout = layout;
+    state.bounds = bounds;
+    state.first_line = (uint32_t)layout->line_count;
+    state.width = width;
+    state.height = height;
+
+    buffer_foreach_line(buffer, layout_line, &state);
+
+    layout->size.height =
+        (int32_t)floorf((float)layout->line_count * height);
+}
+
+static
+void
+layout_line(uint8_t const * const indices,
+            size_t const count,
+            uint32_t const line,
+            void * const data)
+{
+    struct layout_state * const state = (struct layout_state *)data;
+
+    // note that lines are always measured; even those that are out of bounds
+    layout_add_line(state->layout,
+                    (int32_t)floorf((float)count * state->width));
+
+    uint32_t const absolute_line = state->first_line + line;
+
+    float const y = (float)absolute_line * state->height;
+
+    if (state->bounds.size.height != TERM_BOUNDS_UNBOUNDED &&
+        y + state->height > (float)state->bounds.size.height) {
+        // don't lay out anything out of bounds
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        uint8_t const index = indices[i];
+
+        if (index == CODEPAGE_SPACE) {
+            // don't lay out stuff we don't need to print
+            continue;
+        }
+
+        layout_add_glyph(state->layout, (struct layout_glyph) {
+            .x = (float)i * state->width,
+            .y = y,
+            .line = absolute_line,
+            .index = index
+        });
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <termlike/bounds.h> // term_bounds, term_dimens :completeness
+
+#include <stdint.h> // uint8_t, uint32_t, int32_t
+#include <stddef.h> // size_t
+
+struct buffer;
+
+/**
+ * Represents a glyph positioned at an offset from the origin of a string.
+ */
+struct layout_glyph {
+    /**
+     * The offset (in pixels) from the origin of the string.
+     *
+     * This offset is prior to any alignment or rotation being applied.
+     */
+    float x, y;
+    /**
+     * The line that the glyph is on.
+     */
+    uint32_t line;
+    /**
+     * The index of the glyph in the codepage.
+     */
+    uint8_t index;
+};
+
+/**
+ * Represents a string of glyphs laid out within bounds.
+ *
+ * Only glyphs that should be drawn are included; e.g. whitespace, linebreaks
+ * and glyphs that are out of bounds are not.
+ */
+struct layout {
+    struct layout_glyph * glyphs;
+    /**
+     * The horizontal dimensions (in pixels) of each line.
+     */
+    int32_t * line_widths;
+    size_t glyph_count;
+    size_t glyph_capacity;
+    size_t line_count;
+    size_t line_capacity;
+    /**
+     * The dimensions of the smallest bounding box that can hold all lines.
+     */
+    struct term_dimens size;
+};
+
+void layout_init(struct layout *);
+void layout_release(struct layout *);
+
+/**
+ * Clear all glyphs and lines of a layout.
+ *
+ * Memory is retained, so that the layout can be reused without allocating.
+ */
+void layout_clear(struct layout *);
+
+void layout_add_glyph(struct layout *, struct layout_glyph);
+void layout_add_line(struct layout *, int32_t width);
+
+/**
+ * Lay out the lines of a buffer within bounds, with each character taking up
+ * the given dimensions (in pixels).
+ *
+ * Glyph offsets, line widths and the size of the layout are all determined
+ * in a single pass over the lines of the buffer; so the buffer must have been
+ * wrapped first (see buffer_wrap).
+ *
+ * Lines are added below any lines already in the layout; i.e. a layout can
+ * be made from several buffers, one after another.
+ */
+void layout_buffer(struct layout *,
+                   struct buffer const *,
+                   struct term_bounds,
+                   float width,
+                   float height);
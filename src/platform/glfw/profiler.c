@@ -2,6 +2,7 @@
 #include <termlike/platform/profiler.h> // profiler_*
 
 #include <stdint.h> // uint16_t, int32_t, UINT16_MAX
+#include <stddef.h> // size_t
 #include <stdio.h> // sprintf
 
 #if defined(__clang__)
@@ -27,8 +28,9 @@ static double last_average_time = 0;
 static uint16_t frames_per_second = 0;
 
 static double frame_time = 0;
+static double fence_wait_time = 0;
 
-static char stats_string[32];
+static char stats_string[80];
 
 static struct profiler_stats current;
 
@@ -40,12 +42,17 @@ profiler_reset(void)
     current.frames_per_second = 0;
     current.frames_per_second_min = UINT16_MAX;
     current.frames_per_second_max = 0;
+    current.cache_hits = 0;
+    current.cache_misses = 0;
+    current.arena_peak = 0;
+    current.fence_wait = 0;
 }
 
 void
 profiler_begin(void)
 {
     current.draw_count = 0;
+    current.fence_wait = 0;
 }
 
 void
@@ -54,6 +61,31 @@ profiler_increment_draw_count(uint8_t const amount)
     current.draw_count += amount;
 }
 
+void
+profiler_set_cache_usage(size_t const hits, size_t const misses)
+{
+    current.cache_hits = hits;
+    current.cache_misses = misses;
+}
+
+void
+profiler_set_arena_usage(size_t const peak)
+{
+    current.arena_peak = peak;
+}
+
+void
+profiler_begin_fence_wait(void)
+{
+    fence_wait_time = glfwGetTime();
+}
+
+void
+profiler_end_fence_wait(void)
+{
+    current.fence_wait += (glfwGetTime() - fence_wait_time) * 1000;
+}
+
 void
 profiler_end(void)
 {
@@ -96,6 +128,11 @@ profiler_draw(void)
     term_get_transform(&transform);
     term_set_transform(TERM_TRANSFORM_NONE);
 
+    struct term_font font;
+
+    term_get_font(&font);
+    term_set_font(TERM_FONT_DEFAULT);
+
     struct term_dimens c;
 
     term_measure(TERM_SINGLE_GLYPH, &c);
@@ -121,6 +158,7 @@ profiler_draw(void)
                   aligned(TERM_ALIGN_LEFT));
 
     term_set_transform(transform);
+    term_set_font(font);
 }
 
 void
@@ -132,11 +170,30 @@ profiler_sum(struct profiler_stats const stats, float const load)
         load_pct = 1;
     }
 
-    sprintf(stats_string,
-            "%dFPS %dxDRAW %d%%LOAD",
-            stats.frames_per_second,
-            stats.draw_count,
-            load_pct);
+    size_t const lookups = stats.cache_hits + stats.cache_misses;
+
+    uint16_t const hit_pct = lookups > 0 ?
+        (uint16_t)((stats.cache_hits * 100) / lookups) : 0;
+
+    // only show memory used for copied strings when actually copying strings
+    if (stats.arena_peak > 0) {
+        sprintf(stats_string,
+                "%dFPS %dxDRAW %.2fMSWAIT %d%%LOAD %d%%HIT %uKB",
+                stats.frames_per_second,
+                stats.draw_count,
+                stats.fence_wait,
+                load_pct,
+                hit_pct,
+                (uint32_t)(stats.arena_peak / 1024));
+    } else {
+        sprintf(stats_string,
+                "%dFPS %dxDRAW %.2fMSWAIT %d%%LOAD %d%%HIT",
+                stats.frames_per_second,
+                stats.draw_count,
+                stats.fence_wait,
+                load_pct,
+                hit_pct);
+    }
 }
 
 struct profiler_stats
@@ -0,0 +1,186 @@
+#include <termlike/platform/workers.h> // workers, workers_*
+
+#include <stdlib.h> // malloc, free
+#include <stdint.h> // uint64_t
+#include <stddef.h> // size_t, NULL
+#include <stdbool.h> // bool
+
+#include <pthread.h> // pthread_*
+
+#ifdef DEBUG
+ #include <assert.h> // assert
+#endif
+
+struct worker {
+    struct workers * pool;
+    pthread_t thread;
+    size_t index;
+};
+
+struct workers {
+    struct worker * threads;
+    workers_callback * callback;
+    void * state;
+    pthread_mutex_t mutex;
+    /**
+     * Signaled when a new job is ready, or when shutting down.
+     */
+    pthread_cond_t start;
+    /**
+     * Signaled when the last worker has finished a job.
+     */
+    pthread_cond_t done;
+    /**
+     * The number of workers that have yet to finish the current job.
+     */
+    size_t pending;
+    size_t count;
+    /**
+     * Increases with every job; lets workers tell a new job from a spurious
+     * wakeup.
+     */
+    uint64_t generation;
+    bool is_running;
+};
+
+static void * workers_loop(void *);
+
+struct workers *
+workers_init(size_t const count)
+{
+#ifdef DEBUG
+    assert(count > 0 /* must have at least one worker */);
+#endif
+    struct workers * const pool = malloc(sizeof(struct workers));
+
+    pool->count = count;
+    pool->pending = 0;
+    pool->generation = 0;
+    pool->callback = NULL;
+    pool->state = NULL;
+    pool->is_running = true;
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    // the calling thread is the first worker, so it needs no thread
+    pool->threads = NULL;
+
+    if (count > 1) {
+        pool->threads = malloc(sizeof(struct worker) * (count - 1));
+
+        for (size_t i = 0; i < count - 1; i++) {
+            struct worker * const worker = &pool->threads[i];
+
+            worker->pool = pool;
+            worker->index = i + 1;
+
+            pthread_create(&worker->thread, NULL, workers_loop, worker);
+        }
+    }
+
+    return pool;
+}
+
+void
+workers_release(struct workers * const pool)
+{
+    pthread_mutex_lock(&pool->mutex); {
+        pool->is_running = false;
+
+        pthread_cond_broadcast(&pool->start);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (size_t i = 0; i + 1 < pool->count; i++) {
+        pthread_join(pool->threads[i].thread, NULL);
+    }
+
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    pthread_mutex_destroy(&pool->mutex);
+
+    free(pool->threads);
+    free(pool);
+}
+
+size_t
+workers_count(struct workers const * const pool)
+{
+    return pool->count;
+}
+
+void
+workers_run(struct workers * const pool,
+            workers_callback * const callback,
+            void * const state)
+{
+    if (pool->count == 1) {
+        callback(0, 1, state);
+
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex); {
+        pool->callback = callback;
+        pool->state = state;
+        pool->pending = pool->count - 1;
+        pool->generation += 1;
+
+        pthread_cond_broadcast(&pool->start);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    callback(0, pool->count, state);
+
+    pthread_mutex_lock(&pool->mutex); {
+        while (pool->pending > 0) {
+            pthread_cond_wait(&pool->done, &pool->mutex);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+static
+void *
+workers_loop(void * const data)
+{
+    struct worker const * const worker = (struct worker *)data;
+    struct workers * const pool = worker->pool;
+
+    uint64_t generation = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+
+    while (true) {
+        while (pool->is_running && pool->generation == generation) {
+            pthread_cond_wait(&pool->start, &pool->mutex);
+        }
+
+        if (!pool->is_running) {
+            break;
+        }
+
+        generation = pool->generation;
+
+        workers_callback * const callback = pool->callback;
+        void * const state = pool->state;
+
+        pthread_mutex_unlock(&pool->mutex);
+
+        callback(worker->index, pool->count, state);
+
+        pthread_mutex_lock(&pool->mutex);
+
+        pool->pending -= 1;
+
+        if (pool->pending == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
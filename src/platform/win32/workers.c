@@ -0,0 +1,186 @@
+#include <termlike/platform/workers.h> // workers, workers_*
+
+#include <stdlib.h> // malloc, free
+#include <stdint.h> // uint64_t
+#include <stddef.h> // size_t, NULL
+#include <stdbool.h> // bool
+
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h> // CreateThread, WaitForSingleObject, *ConditionVariable*, *CriticalSection
+
+#ifdef DEBUG
+ #include <assert.h> // assert
+#endif
+
+struct worker {
+    struct workers * pool;
+    HANDLE thread;
+    size_t index;
+};
+
+struct workers {
+    struct worker * threads;
+    workers_callback * callback;
+    void * state;
+    CRITICAL_SECTION mutex;
+    /**
+     * Signaled when a new job is ready, or when shutting down.
+     */
+    CONDITION_VARIABLE start;
+    /**
+     * Signaled when the last worker has finished a job.
+     */
+    CONDITION_VARIABLE done;
+    /**
+     * The number of workers that have yet to finish the current job.
+     */
+    size_t pending;
+    size_t count;
+    /**
+     * Increases with every job; lets workers tell a new job from a spurious
+     * wakeup.
+     */
+    uint64_t generation;
+    bool is_running;
+};
+
+static DWORD WINAPI workers_loop(LPVOID);
+
+struct workers *
+workers_init(size_t const count)
+{
+#ifdef DEBUG
+    assert(count > 0 /* must have at least one worker */);
+#endif
+    struct workers * const pool = malloc(sizeof(struct workers));
+
+    pool->count = count;
+    pool->pending = 0;
+    pool->generation = 0;
+    pool->callback = NULL;
+    pool->state = NULL;
+    pool->is_running = true;
+
+    InitializeCriticalSection(&pool->mutex);
+    InitializeConditionVariable(&pool->start);
+    InitializeConditionVariable(&pool->done);
+
+    // the calling thread is the first worker, so it needs no thread
+    pool->threads = NULL;
+
+    if (count > 1) {
+        pool->threads = malloc(sizeof(struct worker) * (count - 1));
+
+        for (size_t i = 0; i < count - 1; i++) {
+            struct worker * const worker = &pool->threads[i];
+
+            worker->pool = pool;
+            worker->index = i + 1;
+            worker->thread = CreateThread(NULL, 0, workers_loop, worker, 0, NULL);
+        }
+    }
+
+    return pool;
+}
+
+void
+workers_release(struct workers * const pool)
+{
+    EnterCriticalSection(&pool->mutex); {
+        pool->is_running = false;
+
+        WakeAllConditionVariable(&pool->start);
+    }
+    LeaveCriticalSection(&pool->mutex);
+
+    for (size_t i = 0; i + 1 < pool->count; i++) {
+        WaitForSingleObject(pool->threads[i].thread, INFINITE);
+        CloseHandle(pool->threads[i].thread);
+    }
+
+    DeleteCriticalSection(&pool->mutex);
+
+    free(pool->threads);
+    free(pool);
+}
+
+size_t
+workers_count(struct workers const * const pool)
+{
+    return pool->count;
+}
+
+void
+workers_run(struct workers * const pool,
+            workers_callback * const callback,
+            void * const state)
+{
+    if (pool->count == 1) {
+        callback(0, 1, state);
+
+        return;
+    }
+
+    EnterCriticalSection(&pool->mutex); {
+        pool->callback = callback;
+        pool->state = state;
+        pool->pending = pool->count - 1;
+        pool->generation += 1;
+
+        WakeAllConditionVariable(&pool->start);
+    }
+    LeaveCriticalSection(&pool->mutex);
+
+    callback(0, pool->count, state);
+
+    EnterCriticalSection(&pool->mutex); {
+        while (pool->pending > 0) {
+            SleepConditionVariableCS(&pool->done, &pool->mutex, INFINITE);
+        }
+    }
+    LeaveCriticalSection(&pool->mutex);
+}
+
+static
+DWORD WINAPI
+workers_loop(LPVOID const data)
+{
+    struct worker const * const worker = (struct worker *)data;
+    struct workers * const pool = worker->pool;
+
+    uint64_t generation = 0;
+
+    EnterCriticalSection(&pool->mutex);
+
+    while (true) {
+        while (pool->is_running && pool->generation == generation) {
+            SleepConditionVariableCS(&pool->start, &pool->mutex, INFINITE);
+        }
+
+        if (!pool->is_running) {
+            break;
+        }
+
+        generation = pool->generation;
+
+        workers_callback * const callback = pool->callback;
+        void * const state = pool->state;
+
+        LeaveCriticalSection(&pool->mutex);
+
+        callback(worker->index, pool->count, state);
+
+        EnterCriticalSection(&pool->mutex);
+
+        pool->pending -= 1;
+
+        if (pool->pending == 0) {
+            WakeConditionVariable(&pool->done);
+        }
+    }
+
+    LeaveCriticalSection(&pool->mutex);
+
+    return 0;
+}
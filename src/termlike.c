@@ -8,25 +8,34 @@
 #include <termlike/graphics/renderer.h> // graphics_context, graphics_*
 #include <termlike/graphics/viewport.h> // viewport
 #include <termlike/graphics/loader.h> // load_image_data
+#include <termlike/graphics/codepage.h> // codepage, codepage_*, CODEPAGE_*
 #include <termlike/platform/window.h> // window_size, window_params, window_*
 #include <termlike/platform/timer.h> // timer, timer_*
 
 #include <termlike/resources/spritefont.8x8.h> // IBM8x8*
+#include <termlike/resources/cp437.h> // CP437, CP437_LENGTH
 
 #ifdef TERM_INCLUDE_PROFILER
  #include <termlike/platform/profiler.h> // profiler_*
 #endif
 
-#include "internal.h" // term_get_display_*
-#include "buffer.h" // buffer, buffer_*, MAX_TEXT_LENGTH
+#include "internal.h" // term_get_display_*, term_layout_text
+#include "buffer.h" // buffer, buffer_*
 #include "command.h" // command_buffer, command, command_*
-#include "cursor.h" // cursor, cursor_offset, cursor_*
+#include "layout.h" // layout, layout_glyph, layout_*
+#include "decode.h" // decode_count
+
+#ifdef TERM_USE_LAYOUT_CACHE
+ #include "cache.h" // layout_cache, cache_*
+#endif
 
 #include <stdlib.h> // malloc, free
-#include <stdint.h> // uint16_t, uint32_t, int32_t
+#include <stdint.h> // uint8_t, uint16_t, uint32_t, uint64_t, int32_t, PTRDIFF_MAX
 #include <stddef.h> // size_t, NULL
 #include <stdbool.h> // bool
 
+#include <string.h> // memcpy, strlen
+
 #ifdef _WIN32
  #define _USE_MATH_DEFINES
 #endif
@@ -39,80 +48,105 @@
 
 #define PIXEL(x) ((int32_t)floorf(x))
 
-/**
- * Provides a count that can be accumulated for each printable character
- * in a buffer.
- */
-struct term_state_count {
-    size_t count;
-};
+#ifdef _MSC_VER
+ #define TERM_THREAD_LOCAL __declspec(thread)
+#else
+ #define TERM_THREAD_LOCAL __thread
+#endif
 
+#ifdef TERM_USE_LAYOUT_CACHE
 /**
- * Provides widths for all lines in a buffer.
+ * The maximum number of laid out strings kept between frames.
  */
-struct term_lines {
-    /**
-     * A pointer to a buffer of line widths.
-     */
-    int32_t * widths;
-    /**
-     * The size of the buffer.
-     */
-    size_t capacity;
-};
+ #define LAYOUT_CACHE_CAPACITY 512
+#endif
 
 /**
- * Provides values for accumulating the required dimensions of
- * printable characters in a buffer.
+ * Provides values for rendering the glyphs of a layout.
  */
-struct term_state_measure {
-    struct term_lines * lines;
-    struct cursor cursor;
+struct term_state_print {
     struct term_bounds bounds;
+    uint8_t font;
+    struct graphics_color tint;
+    struct viewport_size display;
+    struct graphics_position origin;
+    struct layout const * layout;
+    struct term_list * list;
+    struct term_scale scale;
+    struct term_anchor anchor;
+    float width;
+    float height;
+    float radians;
+    enum term_rotate rotation;
 };
 
 /**
- * Provides measured values for the contents of a buffer.
+ * Represents a range of glyphs in a list that share the same depth.
  */
-struct term_measurement {
+struct term_list_run {
     /**
-     * The horizontal dimensions of each line in the measured buffer contents.
+     * The glyphs of the run (only valid once recording has ended).
      */
-    int32_t * line_widths;
+    struct command_glyphs glyphs;
     /**
-     * The number of lines measured.
+     * The index of the first command recorded into the run.
      */
-    size_t line_count;
+    uint64_t index;
     /**
-     * The dimensions of the smallest bounding box that can hold the measured
-     * buffer contents.
+     * The offset of the first glyph of the run.
      */
-    struct term_dimens size;
+    size_t offset;
 };
 
 /**
- * Provides values for rendering printable characters in a buffer.
+ * Represents a retained list of glyphs.
  */
-struct term_state_print {
-    struct cursor cursor;
-    struct term_bounds bounds;
-    struct graphics_color tint;
-    struct viewport_size display;
-    struct graphics_position origin;
-    struct term_measurement * measured;
-    struct term_scale scale;
-    struct term_anchor anchor;
-    float radians;
-    enum term_rotate rotation;
+struct term_list {
+    /**
+     * The queue that prints are issued to while recording.
+     */
+    struct command_buffer * queue;
+    struct graphics_glyph * glyphs;
+    struct term_list_run * runs;
+    size_t glyph_count;
+    size_t glyph_capacity;
+    size_t run_count;
+    size_t run_capacity;
+    bool is_valid;
 };
 
 struct term_attributes {
     struct term_transform transform;
+    struct term_font font;
     // todo: linespacing; maybe just a term_dimens for glyph padding
     //       essentially same as linespacing, but also adds horizonta padding
     // todo: note that this would have to be captured per command, just like transform
 };
 
+/**
+ * Represents a queue that can be filled from another thread.
+ */
+struct term_queue {
+    struct command_buffer * buffer;
+    /**
+     * The attributes applied to prints into this queue.
+     *
+     * These are kept separate from the attributes of the terminal, so that
+     * a thread can change them without affecting prints from other threads.
+     */
+    struct term_attributes attributes;
+    uint32_t order;
+};
+
+/**
+ * Represents a font waiting for its image to be loaded.
+ */
+struct term_font_request {
+    struct graphics_font layout;
+    struct term_font * font;
+    bool is_added;
+};
+
 /**
  * Represents a Termlike display.
  */
@@ -121,14 +155,30 @@ struct term_context {
     term_tick_callback * tick_func;
     struct window_context * window;
     struct graphics_context * graphics;
+    /**
+     * The mapping from characters to glyphs (the same for every font).
+     */
+    struct codepage * codepage;
     struct timer * timer;
     struct buffer * buffer;
     struct command_buffer * queue;
-    struct term_lines lines;
+    struct term_list * recording;
+    /**
+     * All created queues, in the order they are merged (see `term_queue`).
+     */
+    struct term_queue ** queues;
+    size_t queue_count;
+    size_t queue_capacity;
+#ifdef TERM_USE_LAYOUT_CACHE
+    struct layout_cache * cache;
+#else
+    struct layout layout;
+#endif
     struct term_attributes attributes;
     struct term_key_state keys;
     struct term_key_state previous_keys;
     struct term_cursor_state cursor;
+    bool copy_text;
     bool is_open;
 #ifdef TERM_INCLUDE_PROFILER
     bool is_profiling;
@@ -140,7 +190,9 @@ struct term_context {
  *
  * This includes initializing a renderer, timer and buffers.
  */
-static bool term_setup(struct window_size);
+static bool term_setup(struct window_size,
+                       uint8_t threads,
+                       uint32_t max_glyphs);
 /**
  * Invalidate the terminal display.
  *
@@ -170,14 +222,33 @@ static void term_draw(double interpolate);
  */
 static void term_copy_str(char const * text,
                           struct term_bounds,
-                          struct term_scale);
+                          float width);
+/**
+ * Return the max number of characters per line within bounds (or zero, if
+ * unbounded), given the width of a character.
+ */
+static size_t term_get_wrap_limit(struct term_bounds, float width);
 
 /**
- * Measure the contents of the internal buffer.
+ * Lay out a string within bounds.
+ */
+static void term_layout_str(char const * text,
+                            struct term_bounds,
+                            struct term_scale,
+                            struct graphics_font,
+                            struct layout *);
+/**
+ * Return the layout of a string within bounds.
+ *
+ * The layout is looked up in the cache (if enabled), and only laid out
+ * when not already cached.
+ *
+ * The returned layout remains valid until the next call to this function.
  */
-static void term_measure_buffer(struct term_bounds,
-                                struct term_scale,
-                                struct term_measurement *);
+static struct layout const * term_get_layout(char const * text,
+                                             struct term_bounds,
+                                             struct term_scale,
+                                             struct graphics_font);
 
 /**
  * Toggle between fullscreen and windowed mode for the display.
@@ -187,47 +258,92 @@ static void term_measure_buffer(struct term_bounds,
  */
 static void term_toggle_fullscreen(void);
 
+/**
+ * Return the queue that prints are currently issued to.
+ *
+ * This is the queue bound to the calling thread, if any, or the queue of the
+ * list being recorded, if any.
+ */
+static struct command_buffer * term_get_queue(void);
+/**
+ * Return the attributes that prints are currently issued with.
+ */
+static struct term_attributes * term_get_attributes(void);
+/**
+ * Merge the contents of every queue into the terminal queue.
+ */
+static void term_merge_queues(void);
+/**
+ * Clear the contents of every queue.
+ */
+static void term_clear_queues(void);
+
 /**
  * Handle a command.
  *
+ * If a list is provided, glyphs are recorded into that list instead of being
+ * drawn.
+ *
  * This function can be passed to a command buffer when flushing.
  */
-static void term_print_command(struct command const *);
+static void term_print_command(struct command const *,
+                               struct command_attributes,
+                               void * list);
+/**
+ * Record a glyph into a list.
+ */
+static void term_list_add(struct term_list *, struct graphics_glyph);
 
 /**
- * Print a character at an offset.
- *
- * This function can be passed to a buffer as a character callback.
+ * Copy a grid, along with its cells and transformations, into memory that
+ * remains valid until a queue is flushed.
  */
-static void term_print_character(uint32_t character, void *);
+static struct term_grid const * term_copy_grid(struct command_buffer *,
+                                               struct term_grid const *);
 /**
- * Count a character in a buffer.
- *
- * This function can be passed to a buffer as a character callback.
+ * Print a grid of cells.
  */
-static void term_count_character(uint32_t character, void *);
+static void term_print_grid(struct command const *,
+                            struct term_transform const *,
+                            struct term_list *);
 /**
- * Measure a character in a buffer.
- *
- * This function can be passed to a buffer as a character callback.
+ * Apply a transformation to a state for printing glyphs.
  */
-static void term_measure_character(uint32_t character, void *);
+static void term_set_print_transform(struct term_state_print *,
+                                     struct term_transform const *,
+                                     struct graphics_font);
+/**
+ * Print a laid out glyph.
+ */
+static void term_print_glyph(struct term_state_print const *,
+                             struct layout_glyph);
 
 /**
- * Handle a font image being loaded into memory.
+ * Return the font that prints are currently issued with.
+ */
+static struct graphics_font term_get_graphics_font(void);
+
+/**
+ * Handle a font image being loaded into memory, and add it to the fonts
+ * held by the renderer (see `term_font_request`).
  *
  * This function can be passed to `load_image_data` as a callback.
  *
  * Note that the image data is released immediately after this function has
  * completed.
  */
-static void term_load_font(struct graphics_image);
+static void term_add_font(struct graphics_image, void *);
 
 /**
  * The one and only terminal object.
  */
 static struct term_context terminal;
 
+/**
+ * The queue bound to the calling thread, if any.
+ */
+static TERM_THREAD_LOCAL struct term_queue * bound_queue = NULL;
+
 bool
 term_open(struct term_settings const settings)
 {
@@ -255,10 +371,12 @@ term_open(struct term_settings const settings)
         return false;
     }
 
-    if (!term_setup(display)) {
+    if (!term_setup(display, settings.threads, settings.max_glyphs)) {
         return false;
     }
 
+    terminal.copy_text = settings.copy_text;
+
     terminal.is_open = true;
 
     return terminal.is_open;
@@ -271,13 +389,24 @@ term_close(void)
         return false;
     }
 
-    free(terminal.lines.widths);
+#ifdef TERM_USE_LAYOUT_CACHE
+    cache_release(terminal.cache);
+#else
+    layout_release(&terminal.layout);
+#endif
 
     graphics_release(terminal.graphics);
+
+    codepage_release(terminal.codepage);
     timer_release(terminal.timer);
     command_release(terminal.queue);
     buffer_release(terminal.buffer);
 
+#ifdef DEBUG
+    assert(terminal.queue_count == 0 /* all queues must be released */);
+#endif
+    free(terminal.queues);
+
     window_terminate(terminal.window);
 
     terminal = (struct term_context const) { 0 };
@@ -340,13 +469,52 @@ term_run(uint16_t const frequency)
 void
 term_set_transform(struct term_transform const transform)
 {
-    terminal.attributes.transform = transform;
+    term_get_attributes()->transform = transform;
 }
 
 void
 term_get_transform(struct term_transform * const transform)
 {
-    *transform = terminal.attributes.transform;
+    *transform = term_get_attributes()->transform;
+}
+
+bool
+term_load_font(uint8_t const * const data,
+               size_t const length,
+               uint16_t const glyph_size,
+               struct term_font * const font)
+{
+#ifdef DEBUG
+    assert(data != NULL);
+    assert(glyph_size > 0);
+#endif
+    struct term_font_request request = (struct term_font_request) {
+        .layout = (struct graphics_font) {
+            .columns = 16,
+            .rows = 16,
+            .size = glyph_size
+        },
+        .font = font,
+        .is_added = false
+    };
+
+    if (!load_image_data(data, (int32_t)length, term_add_font, &request)) {
+        return false;
+    }
+
+    return request.is_added;
+}
+
+void
+term_set_font(struct term_font const font)
+{
+    term_get_attributes()->font = font;
+}
+
+void
+term_get_font(struct term_font * const font)
+{
+    *font = term_get_attributes()->font;
 }
 
 void
@@ -377,19 +545,91 @@ term_printstr(char const * const text,
 
     term_get_transform(&transform);
 
-    uint32_t const index = command_next_layered_index(terminal.queue,
-                                                      position.layer);
+    struct command_buffer * const queue = term_get_queue();
+
+    uint64_t const index = command_next_layered_index(queue, position.layer);
+
+    struct command cmd = (struct command) {
+        .index = index,
+        .type = COMMAND_TYPE_TEXT,
+        .content.text = terminal.copy_text ?
+            command_copy_str(queue, text) : text,
+        .transform = command_intern_transform(queue, &transform),
+        .origin = position.location,
+        .bounds = command_intern_bounds(queue, &bounds),
+        .color = color,
+        .font = term_get_attributes()->font.id
+    };
+
+    command_push(queue, cmd);
+}
+
+void
+term_print_text(struct term_text * const text,
+                struct term_position const position,
+                struct term_color const color,
+                struct term_bounds const bounds)
+{
+#ifdef DEBUG
+    assert(text != NULL /* can't print nothing */);
+#endif
+    struct term_transform transform;
+
+    term_get_transform(&transform);
+
+    struct command_buffer * const queue = term_get_queue();
+
+    uint64_t const index = command_next_layered_index(queue, position.layer);
 
+    // note that the text is never copied; it is laid out on flush, as it is
+    // at that point
     struct command cmd = (struct command) {
         .index = index,
-        .text = text,
-        .transform = transform,
+        .type = COMMAND_TYPE_TEXT_OBJECT,
+        .content.text_object = text,
+        .transform = command_intern_transform(queue, &transform),
+        .origin = position.location,
+        .bounds = command_intern_bounds(queue, &bounds),
+        .color = color,
+        .font = term_get_attributes()->font.id
+    };
+
+    command_push(queue, cmd);
+}
+
+void
+term_print_cells(struct term_grid const * grid,
+                 struct term_position const position)
+{
+#ifdef DEBUG
+    assert(grid != NULL /* can't print nothing */);
+    assert(grid->columns > 0 /* grid must have at least one column */);
+#endif
+    if (grid->count == 0) {
+        return;
+    }
+
+    struct term_transform transform;
+
+    term_get_transform(&transform);
+
+    struct command_buffer * const queue = term_get_queue();
+
+    if (terminal.copy_text) {
+        grid = term_copy_grid(queue, grid);
+    }
+
+    struct command cmd = (struct command) {
+        .index = command_next_layered_index(queue, position.layer),
+        .type = COMMAND_TYPE_CELLS,
+        .content.grid = grid,
+        .transform = command_intern_transform(queue, &transform),
         .origin = position.location,
-        .bounds = bounds,
-        .color = color
+        .bounds = command_intern_bounds(queue, &TERM_BOUNDS_NONE),
+        .font = term_get_attributes()->font.id
     };
 
-    command_push(terminal.queue, cmd);
+    command_push(queue, cmd);
 }
 
 void
@@ -401,9 +641,7 @@ term_fill(struct term_position const position,
         return;
     }
 
-    struct graphics_font font;
-
-    graphics_get_font(terminal.graphics, &font);
+    struct graphics_font const font = term_get_graphics_font();
 
     float const h = (float)size.width / (float)font.size;
     float const v = (float)size.height / (float)font.size;
@@ -424,23 +662,207 @@ term_fill(struct term_position const position,
     term_set_transform(previous_transform);
 }
 
+struct term_list *
+term_create_list(void)
+{
+    struct term_list * const list = malloc(sizeof(struct term_list));
+
+    list->queue = command_init();
+
+    list->glyph_count = 0;
+    list->glyph_capacity = UINT8_MAX + 1;
+    list->glyphs = malloc(sizeof(struct graphics_glyph) * list->glyph_capacity);
+
+    list->run_count = 0;
+    list->run_capacity = 4; // default 4 runs, expands when needed
+    list->runs = malloc(sizeof(struct term_list_run) * list->run_capacity);
+
+    list->is_valid = false;
+
+    return list;
+}
+
+void
+term_release_list(struct term_list * const list)
+{
+#ifdef DEBUG
+    assert(terminal.recording != list /* can't release while recording */);
+#endif
+    command_release(list->queue);
+
+    free(list->glyphs);
+    free(list->runs);
+    free(list);
+}
+
+void
+term_begin_list(struct term_list * const list)
+{
+#ifdef DEBUG
+    assert(terminal.recording == NULL /* already recording a list */);
+    assert(bound_queue == NULL /* can't record a list into a queue */);
+#endif
+    term_invalidate_list(list);
+
+    terminal.recording = list;
+}
+
+void
+term_end_list(void)
+{
+    struct term_list * const list = terminal.recording;
+
+#ifdef DEBUG
+    assert(list != NULL /* not recording a list */);
+#endif
+    terminal.recording = NULL;
+
+    command_flush(list->queue, term_print_command, list);
+
+    // glyphs have stopped moving around, so runs can now point to them
+    for (size_t i = 0; i < list->run_count; i++) {
+        struct term_list_run * const run = &list->runs[i];
+
+        size_t const end = (i + 1 < list->run_count) ?
+            list->runs[i + 1].offset : list->glyph_count;
+
+        run->glyphs.glyphs = &list->glyphs[run->offset];
+        run->glyphs.count = end - run->offset;
+    }
+
+    list->is_valid = true;
+}
+
+void
+term_print_list(struct term_list const * const list)
+{
+#ifdef DEBUG
+    assert(list->is_valid /* list must be recorded */);
+    assert(terminal.recording != list /* can't print list into itself */);
+#endif
+    struct command_buffer * const queue = term_get_queue();
+
+    for (size_t i = 0; i < list->run_count; i++) {
+        struct term_list_run const * const run = &list->runs[i];
+
+        if (run->glyphs.count == 0) {
+            continue;
+        }
+
+        // each run becomes a single command; the transform, origin, bounds
+        // and color have all been applied to each glyph already
+        struct command cmd = (struct command) {
+            .index = command_next_depth_index(queue, run->index),
+            .type = COMMAND_TYPE_GLYPHS,
+            .content.glyphs = &run->glyphs,
+            .transform = command_intern_transform(queue, &TERM_TRANSFORM_NONE),
+            .bounds = command_intern_bounds(queue, &TERM_BOUNDS_NONE)
+        };
+
+        command_push(queue, cmd);
+    }
+}
+
+void
+term_invalidate_list(struct term_list * const list)
+{
+    list->glyph_count = 0;
+    list->run_count = 0;
+
+    list->is_valid = false;
+}
+
+struct term_queue *
+term_create_queue(uint32_t const order)
+{
+    struct term_queue * const queue = malloc(sizeof(struct term_queue));
+
+    queue->buffer = command_init();
+    queue->attributes.transform = TERM_TRANSFORM_NONE;
+    queue->attributes.font = TERM_FONT_DEFAULT;
+    queue->order = order;
+
+    if (terminal.queue_count == terminal.queue_capacity) {
+        terminal.queue_capacity *= 2;
+        terminal.queues = realloc(terminal.queues,
+                                  sizeof(struct term_queue *) *
+                                  terminal.queue_capacity);
+    }
+
+    // keep queues sorted by order; searching from the back so that queues
+    // of equal order remain in the order they were created
+    size_t i = terminal.queue_count;
+
+    while (i > 0 && terminal.queues[i - 1]->order > order) {
+        terminal.queues[i] = terminal.queues[i - 1];
+
+        i--;
+    }
+
+    terminal.queues[i] = queue;
+    terminal.queue_count += 1;
+
+    return queue;
+}
+
+void
+term_release_queue(struct term_queue * const queue)
+{
+#ifdef DEBUG
+    assert(bound_queue != queue /* can't release while bound */);
+#endif
+    size_t i = 0;
+
+    while (i < terminal.queue_count && terminal.queues[i] != queue) {
+        i++;
+    }
+
+#ifdef DEBUG
+    assert(i < terminal.queue_count /* queue was not created by terminal */);
+#endif
+
+    for (; i + 1 < terminal.queue_count; i++) {
+        terminal.queues[i] = terminal.queues[i + 1];
+    }
+
+    terminal.queue_count -= 1;
+
+    command_release(queue->buffer);
+
+    free(queue);
+}
+
+void
+term_bind_queue(struct term_queue * const queue)
+{
+    bound_queue = queue;
+}
+
+bool
+term_is_list_valid(struct term_list const * const list)
+{
+    return list->is_valid;
+}
+
 void
 term_count(char const * const text, size_t * const length)
 {
 #ifdef DEBUG
     assert(text != NULL /* can't count nothing */);
 #endif
-    *length = 0;
-
-    // initialize a state for counting number of printable characters
-    struct term_state_count state;
+    size_t const size = strlen(text);
 
-    state.count = 0;
+    // count characters straight from the string; nothing is decoded (unless
+    // validating), so this neither touches nor depends on the terminal
+#ifdef DEBUG
+    int32_t error = 0;
 
-    buffer_copy(terminal.buffer, text, TERM_BOUNDS_UNBOUNDED);
-    buffer_foreach(terminal.buffer, term_count_character, &state);
+    *length = decode_count(text, size, &error);
 
-    *length = state.count;
+    assert(error == 0 /* see utf8.h for error description */);
+#else
+    *length = decode_count(text, size, NULL);
+#endif
 }
 
 void
@@ -472,16 +894,50 @@ term_measurestr(char const * const text,
 
     term_get_transform(&transform);
 
-    struct term_scale const scale = transform.scale;
+    struct layout const * const layout = term_get_layout(text,
+                                                         bounds,
+                                                         transform.scale,
+                                                         term_get_graphics_font());
+
+    dimensions->width = layout->size.width;
+    dimensions->height = layout->size.height;
+}
+
+void
+term_measurestrs(char const * const * const texts,
+                 struct term_bounds const * const bounds,
+                 size_t const count,
+                 struct term_dimens * const dimensions)
+{
+#ifdef DEBUG
+    assert(texts != NULL /* can't measure nothing */);
+    assert(bounds != NULL /* each string must have bounds */);
+    assert(dimensions != NULL /* each string must have dimensions */);
+    assert(count <= PTRDIFF_MAX /* count must not be negative */);
+#endif
+    struct term_transform transform;
+
+    term_get_transform(&transform);
+
+    struct graphics_font const font = term_get_graphics_font();
 
-    term_copy_str(text, bounds, scale);
+    float const cw = (float)font.size * transform.scale.horizontal;
+    float const ch = (float)font.size * transform.scale.vertical;
 
-    struct term_measurement measurement;
+    for (size_t i = 0; i < count; i++) {
+#ifdef DEBUG
+        assert(texts[i] != NULL /* can't measure nothing */);
+#endif
+        // every string is decoded into, and wrapped within, the same buffer;
+        // only the resulting lines are needed, not a full layout
+        term_copy_str(texts[i], bounds[i], cw);
 
-    term_measure_buffer(bounds, scale, &measurement);
+        size_t const columns = buffer_widest_line(terminal.buffer);
+        size_t const lines = buffer_line_count(terminal.buffer);
 
-    dimensions->width = measurement.size.width;
-    dimensions->height = measurement.size.height;
+        dimensions[i].width = PIXEL((float)columns * cw);
+        dimensions[i].height = PIXEL((float)lines * ch);
+    }
 }
 
 bool
@@ -519,7 +975,9 @@ term_get_cursor(struct term_cursor_state * const cursor)
 
 static
 bool
-term_setup(struct window_size const display)
+term_setup(struct window_size const display,
+           uint8_t const threads,
+           uint32_t const max_glyphs)
 {
     struct viewport viewport;
 
@@ -533,7 +991,9 @@ term_setup(struct window_size const display)
     viewport.resolution.width = display.width;
     viewport.resolution.height = display.height;
 
-    terminal.graphics = graphics_init(viewport);
+    terminal.graphics = graphics_init(viewport,
+                                      threads > 0 ? threads : 1,
+                                      max_glyphs > 0 ? max_glyphs : 1);
 
     if (terminal.graphics == NULL) {
         return false;
@@ -550,15 +1010,41 @@ term_setup(struct window_size const display)
     terminal.queue = command_init();
     terminal.buffer = buffer_init();
 
-    terminal.lines.capacity = 4; // default 4 lines, expands when needed
-    terminal.lines.widths = malloc(sizeof(int32_t) * terminal.lines.capacity);
+    terminal.queue_count = 0;
+    terminal.queue_capacity = 4; // default 4 queues, expands when needed
+    terminal.queues = malloc(sizeof(struct term_queue *) *
+                             terminal.queue_capacity);
+
+#ifdef TERM_USE_LAYOUT_CACHE
+    terminal.cache = cache_init(LAYOUT_CACHE_CAPACITY);
+#else
+    layout_init(&terminal.layout);
+#endif
 
     terminal.draw_func = NULL;
     terminal.tick_func = NULL;
 
-    load_image_data(IBM8x8_FONT, IBM8x8_SIZE, term_load_font);
+    struct term_font font;
+
+    struct term_font_request request = (struct term_font_request) {
+        .layout = (struct graphics_font) {
+            .columns = IBM8x8_COLUMNS,
+            .rows = IBM8x8_ROWS,
+            .size = IBM8x8_CELL_SIZE
+        },
+        .font = &font,
+        .is_added = false
+    };
+
+    // the default font is always the first font (see TERM_FONT_DEFAULT)
+    load_image_data(IBM8x8_FONT, IBM8x8_SIZE, term_add_font, &request);
+
+    // build the character mapping along with the font, so that looking up
+    // the glyph of any character takes constant time
+    terminal.codepage = codepage_init(CP437, CP437_LENGTH);
 
     term_set_transform(TERM_TRANSFORM_NONE);
+    term_set_font(TERM_FONT_DEFAULT);
 #ifdef TERM_INCLUDE_PROFILER
     terminal.is_profiling = false;
 
@@ -648,6 +1134,12 @@ term_draw(double const interpolate)
         if (terminal.draw_func) {
             terminal.draw_func(interpolate);
         }
+
+#ifdef DEBUG
+        assert(bound_queue == NULL /* queue must be unbound before drawing */);
+#endif
+        // all threads are done printing; commands can now be merged
+        term_merge_queues();
 #ifdef TERM_INCLUDE_PROFILER
         if (terminal.is_profiling) {
             profiler_draw();
@@ -658,13 +1150,40 @@ term_draw(double const interpolate)
             // is being used to accomodate all print commands for a program
             command_get_capacity(terminal.queue, &used, &capacity);
             command_load = (float)used / capacity;
+
+            size_t peak, queue_peak;
+
+            // fetch the high-water mark of memory used for copied strings
+            command_get_arena_usage(terminal.queue, &used, &peak);
+
+            for (size_t i = 0; i < terminal.queue_count; i++) {
+                // strings printed into a queue are copied into its own arena,
+                // and stay there after being merged
+                command_get_arena_usage(terminal.queues[i]->buffer,
+                                        &used, &queue_peak);
+
+                peak += queue_peak;
+            }
+
+            profiler_set_arena_usage(peak);
         }
 #endif
-        command_flush(terminal.queue, term_print_command);
+        command_flush(terminal.queue, term_print_command, NULL);
+
+        term_clear_queues();
     }
     graphics_end(terminal.graphics);
 
 #ifdef TERM_INCLUDE_PROFILER
+ #ifdef TERM_USE_LAYOUT_CACHE
+    size_t hits, misses;
+
+    // fetch cache usage for this frame only
+    cache_get_stats(terminal.cache, &hits, &misses);
+    cache_reset_stats(terminal.cache);
+
+    profiler_set_cache_usage(hits, misses);
+ #endif
     if (terminal.is_profiling) {
         // sum up stats from this frame
         profiler_sum(profiler_stats(), command_load);
@@ -691,116 +1210,116 @@ static
 void
 term_copy_str(char const * const text,
               struct term_bounds const bounds,
-              struct term_scale const scale)
+              float const width)
 {
-    buffer_copy(terminal.buffer, text, bounds.limit);
+    buffer_copy(terminal.buffer, terminal.codepage, text, bounds.limit);
+    buffer_wrap(terminal.buffer,
+                term_get_wrap_limit(bounds, width),
+                bounds.wrap);
+}
 
-    if (bounds.size.width != TERM_BOUNDS_UNBOUNDED &&
-        bounds.wrap == TERM_WRAP_WORDS) {
-        struct graphics_font font;
+static
+size_t
+term_get_wrap_limit(struct term_bounds const bounds, float const width)
+{
+    if (bounds.size.width == TERM_BOUNDS_UNBOUNDED) {
+        return 0;
+    }
 
-        graphics_get_font(terminal.graphics, &font);
+    float const columns = (float)bounds.size.width / width;
 
-        float const cw = (float)font.size * scale.horizontal;
+    size_t limit;
 
-        // determine max number of characters per line
-        size_t const limit = (size_t)floorf((float)bounds.size.width / cw);
+    if (bounds.wrap == TERM_WRAP_WORDS) {
+        // words must fit entirely within bounds
+        limit = (size_t)floorf(columns);
+    } else {
+        // the last character on a line may cross the bounds
+        limit = (size_t)ceilf(columns);
+    }
 
-        buffer_wrap(terminal.buffer, limit);
+    if (limit == 0) {
+        // always fit at least one character on each line
+        limit = 1;
     }
+
+    return limit;
 }
 
 static
 void
-term_measure_buffer(struct term_bounds const bounds,
-                    struct term_scale const scale,
-                    struct term_measurement * const measurement)
+term_layout_str(char const * const text,
+                struct term_bounds const bounds,
+                struct term_scale const scale,
+                struct graphics_font const font,
+                struct layout * const layout)
 {
-    // initialize a state for measuring the smallest bounding box that
-    // contains all lines of the text, and is within specified bounds
-    struct term_state_measure measure;
-
-    struct graphics_font font;
-
-    graphics_get_font(terminal.graphics, &font);
-
-    cursor_start(&measure.cursor,
-                 bounds,
-                 (float)font.size * scale.horizontal,
-                 (float)font.size * scale.vertical);
+    term_copy_str(text, bounds, (float)font.size * scale.horizontal);
+
+    // measure and lay out all lines together, in a single pass over the
+    // buffer; alignment and rotation only need the resulting line widths
+    // and size, so nothing has to be walked again when printing
+    layout_buffer(layout, terminal.buffer, bounds,
+                  (float)font.size * scale.horizontal,
+                  (float)font.size * scale.vertical);
+}
 
-    measure.lines = &terminal.lines;
-    measure.bounds = bounds;
+static
+struct layout const *
+term_get_layout(char const * const text,
+                struct term_bounds const bounds,
+                struct term_scale const scale,
+                struct graphics_font const font)
+{
+#ifdef TERM_USE_LAYOUT_CACHE
+    bool hit;
 
-    buffer_foreach(terminal.buffer, term_measure_character, &measure);
+    struct layout * const layout = cache_get(terminal.cache,
+                                             text, bounds, scale, font.size,
+                                             &hit);
 
-    uint32_t const line_count = measure.cursor.offset.line + 1;
+    if (!hit) {
+        term_layout_str(text, bounds, scale, font, layout);
+    }
 
-    measurement->line_count = line_count;
-    measurement->line_widths = measure.lines->widths;
+    return layout;
+#else
+    struct layout * const layout = &terminal.layout;
 
-    measurement->size.width = 0;
-    measurement->size.height = PIXEL((float)line_count * measure.cursor.height);
+    layout_clear(layout);
 
-    // determine bounding width from the widest line
-    for (uint32_t i = 0; i < line_count; i++) {
-        int32_t const width = measure.lines->widths[i];
+    term_layout_str(text, bounds, scale, font, layout);
 
-        if (measurement->size.width < width) {
-            measurement->size.width = width;
-        }
-    }
+    return layout;
+#endif
 }
 
 static
 void
-term_print_character(uint32_t const character, void * const data)
+term_print_glyph(struct term_state_print const * const state,
+                 struct layout_glyph const glyph)
 {
-    struct term_state_print * const state = (struct term_state_print *)data;
-
-    struct cursor_offset offset;
-
-    cursor_advance(&state->cursor, &offset, character);
-
-    if (character == '\n' ||
-        character == ' ') {
-        // don't print stuff we don't need to
-        return;
-    }
-
-    if (cursor_is_out_of_bounds(&state->cursor)) {
-        // don't draw anything out of bounds
-        return;
-    }
+    struct term_anchor offset = {
+        .x = glyph.x,
+        .y = glyph.y
+    };
 
     if (state->bounds.align == TERM_ALIGN_RIGHT) {
-#ifdef DEBUG
-        assert(state->measured != NULL /* measure required; see term_print_command */);
-#endif
-        offset.x -= (float)state->measured->line_widths[offset.line];
+        offset.x -= (float)state->layout->line_widths[glyph.line];
     } else if (state->bounds.align == TERM_ALIGN_CENTER) {
-#ifdef DEBUG
-        assert(state->measured != NULL /* measure required; see term_print_command */);
-#endif
-        offset.x -= (float)state->measured->line_widths[offset.line] / 2.0f;
+        offset.x -= (float)state->layout->line_widths[glyph.line] / 2.0f;
     }
 
-    float const cw = (float)state->cursor.width;
-    float const ch = (float)state->cursor.height;
+    float const cw = state->width;
+    float const ch = state->height;
 
     if ((state->rotation == TERM_ROTATE_STRING ||
          state->rotation == TERM_ROTATE_STRING_ANCHORED) &&
         (state->radians > 0 || state->radians < 0)) {
-#ifdef DEBUG
-        assert(state->measured != NULL /* measure required; see term_print_command */);
-#endif
-        float const w = (float)state->measured->size.width;
-        float const h = (float)state->measured->size.height;
+        float const w = (float)state->layout->size.width;
+        float const h = (float)state->layout->size.height;
 
-        struct term_anchor const point = {
-            .x = offset.x,
-            .y = offset.y
-        };
+        struct term_anchor const point = offset;
 
         struct term_anchor rotated;
 
@@ -818,8 +1337,7 @@ term_print_character(uint32_t const character, void * const data)
             rotate_point(point, -state->radians, &rotated);
         }
 
-        offset.x = rotated.x;
-        offset.y = rotated.y;
+        offset = rotated;
     }
 
     offset.x += state->origin.x;
@@ -844,123 +1362,162 @@ term_print_character(uint32_t const character, void * const data)
         .angle = state->radians
     };
 
-    graphics_draw(terminal.graphics,
-                  state->tint,
-                  transform,
-                  character);
+    if (state->list != NULL) {
+        term_list_add(state->list, (struct graphics_glyph) {
+            .transform = transform,
+            .color = state->tint,
+            .index = glyph.index,
+            .font = state->font
+        });
+    } else {
+        graphics_draw(terminal.graphics,
+                      state->tint,
+                      transform,
+                      glyph.index,
+                      state->font);
+    }
 }
 
 static
-void
-term_count_character(uint32_t const character, void * const data)
+struct command_buffer *
+term_get_queue(void)
 {
-    (void)character;
+    if (bound_queue != NULL) {
+        return bound_queue->buffer;
+    }
 
-    struct term_state_count * const state = (struct term_state_count *)data;
+    if (terminal.recording != NULL) {
+        return terminal.recording->queue;
+    }
 
-    state->count += 1;
+    return terminal.queue;
+}
+
+static
+struct term_attributes *
+term_get_attributes(void)
+{
+    if (bound_queue != NULL) {
+        return &bound_queue->attributes;
+    }
+
+    return &terminal.attributes;
 }
 
 static
 void
-term_measure_character(uint32_t const character, void * const data)
+term_merge_queues(void)
 {
-    struct term_state_measure * const state = (struct term_state_measure *)data;
+    for (size_t i = 0; i < terminal.queue_count; i++) {
+        command_merge(terminal.queue, terminal.queues[i]->buffer);
+    }
+}
 
-    struct cursor_offset offset;
+static
+void
+term_clear_queues(void)
+{
+    for (size_t i = 0; i < terminal.queue_count; i++) {
+        // merged commands may refer to memory held by the queue, so this
+        // must not happen until the terminal queue has been flushed
+        command_flush(terminal.queues[i]->buffer, NULL, NULL);
+    }
+}
 
-    cursor_advance(&state->cursor, &offset, character);
+static
+void
+term_print_command(struct command const * const command,
+                   struct command_attributes const attributes,
+                   void * const data)
+{
+    struct term_list * const list = (struct term_list *)data;
+
+    if (list != NULL) {
+        // begin a new run whenever depth changes
+        bool const is_new_run = (
+            list->run_count == 0 ||
+            command_index_to_z(list->runs[list->run_count - 1].index) !=
+            command_index_to_z(command->index));
+
+        if (is_new_run) {
+            if (list->run_count == list->run_capacity) {
+                list->run_capacity *= 2;
+                list->runs = realloc(list->runs,
+                                     sizeof(struct term_list_run) *
+                                     list->run_capacity);
+            }
 
-    float edge = offset.x;
+            list->runs[list->run_count] = (struct term_list_run) {
+                .index = command->index,
+                .offset = list->glyph_count
+            };
 
-    if (character != '\n') {
-        edge += state->cursor.width;
+            list->run_count += 1;
+        }
     }
 
-    uint32_t const line_index = offset.line;
-    uint32_t const line_count = line_index + 1;
-
-    if (line_count > state->lines->capacity) {
-        size_t expanded_capacity = state->lines->capacity * 2;
+    if (command->type == COMMAND_TYPE_GLYPHS) {
+        struct command_glyphs const * const glyphs = command->content.glyphs;
 
-        // the maximum number of lines is directly tied to the limits of the
-        // internal text buffer; e.g. the max number of characters it will hold
-        // equals the maximum possible number of lines (if each character
-        // was a newline)
-        if (expanded_capacity > MAX_TEXT_LENGTH) {
-            expanded_capacity = MAX_TEXT_LENGTH;
+        if (list != NULL) {
+            for (size_t i = 0; i < glyphs->count; i++) {
+                term_list_add(list, glyphs->glyphs[i]);
+            }
+        } else {
+            graphics_draw_glyphs(terminal.graphics,
+                                 glyphs->glyphs,
+                                 glyphs->count);
         }
 
-#ifdef DEBUG
-        assert(expanded_capacity > line_count /* could not expand as needed */);
-#endif
+        return;
+    }
+
+    if (command->type == COMMAND_TYPE_CELLS) {
+        term_print_grid(command, attributes.transform, list);
 
-        state->lines->capacity = expanded_capacity;
-        state->lines->widths = realloc(state->lines->widths,
-                                       sizeof(int32_t) * state->lines->capacity);
+        return;
     }
 
-    state->lines->widths[line_index] = PIXEL(edge);
-}
+    struct graphics_font font;
 
-static
-void
-term_print_command(struct command const * const command)
-{
-    term_copy_str(command->text,
-                  command->bounds,
-                  command->transform.scale);
+    graphics_get_font(terminal.graphics, command->font, &font);
 
-    // initialize a state for printing contents of the buffer;
+    // initialize a state for printing the laid out glyphs;
     // this state will hold positional values for the upper-left origin
-    // of the string of characters; each character is drawn at an offset
+    // of the string of glyphs; each glyph is drawn at an offset
     // from these initial values
     struct term_state_print state;
-    struct term_measurement measurement;
-
-    state.measured = NULL;
 
-    // measurements of buffer are only required ahead of time, if:
-    //  1) alignment is not default (left), or
-    //  2) rotation is applied (to string)
-    if (command->bounds.align != TERM_ALIGN_LEFT ||
-        ((command->transform.rotate.rotation == TERM_ROTATE_STRING_ANCHORED ||
-          command->transform.rotate.rotation == TERM_ROTATE_STRING) &&
-         command->transform.rotate.angle != 0)) {
-        term_measure_buffer(command->bounds,
-                            command->transform.scale,
-                            &measurement);
+    if (command->type == COMMAND_TYPE_TEXT_OBJECT) {
+        struct term_scale const scale = attributes.transform->scale;
 
-        state.measured = &measurement;
+        float const cw = (float)font.size * scale.horizontal;
+        float const ch = (float)font.size * scale.vertical;
+
+        state.layout = term_layout_text(command->content.text_object,
+                                        terminal.codepage,
+                                        *attributes.bounds,
+                                        term_get_wrap_limit(*attributes.bounds,
+                                                            cw),
+                                        cw, ch);
+    } else {
+        state.layout = term_get_layout(command->content.text,
+                                       *attributes.bounds,
+                                       attributes.transform->scale,
+                                       font);
     }
 
-    struct graphics_font font;
-
-    graphics_get_font(terminal.graphics, &font);
+    state.list = list;
+    state.font = command->font;
 
-    cursor_start(&state.cursor, command->bounds,
-                 (float)font.size * command->transform.scale.horizontal,
-                 (float)font.size * command->transform.scale.vertical);
+    term_set_print_transform(&state, attributes.transform, font);
 
-    state.bounds = command->bounds;
+    state.bounds = *attributes.bounds;
 
     state.origin.x = (float)command->origin.x;
     state.origin.y = (float)command->origin.y;
     state.origin.z = command_index_to_z(command->index);
 
-    struct term_rotation const rotate = command->transform.rotate;
-
-    state.rotation = rotate.rotation;
-    state.anchor = rotate.anchor;
-
-    state.radians = 0;
-
-    if (rotate.angle != 0 && rotate.angle != 360) {
-        state.radians = (float)((rotate.angle * M_PI) / 180.0f);
-    }
-
-    state.scale = command->transform.scale;
-
     state.tint = (struct graphics_color) {
         .r = command->color.r,
         .g = command->color.g,
@@ -974,18 +1531,189 @@ term_print_command(struct command const * const command)
 
     state.display = viewport.resolution;
 
-    buffer_foreach(terminal.buffer, term_print_character, &state);
+    for (size_t i = 0; i < state.layout->glyph_count; i++) {
+        term_print_glyph(&state, state.layout->glyphs[i]);
+    }
+}
+
+static
+struct graphics_font
+term_get_graphics_font(void)
+{
+    struct graphics_font font;
+
+    graphics_get_font(terminal.graphics, term_get_attributes()->font.id, &font);
+
+    return font;
 }
 
 static
 void
-term_load_font(struct graphics_image const image)
+term_add_font(struct graphics_image const image, void * const data)
 {
+    struct term_font_request * const request = (struct term_font_request *)data;
+
+    uint8_t id;
+
+    request->is_added = graphics_add_font(terminal.graphics,
+                                          image,
+                                          request->layout,
+                                          &id);
+
+    if (request->is_added) {
+        request->font->id = id;
+    }
+}
+
+static
+struct term_grid const *
+term_copy_grid(struct command_buffer * const queue,
+               struct term_grid const * const grid)
+{
+    struct term_grid * const copy = command_alloc(queue,
+                                                  sizeof(struct term_grid));
+
+    *copy = *grid;
+
+    size_t const cells_size = sizeof(struct term_cell) * grid->count;
+
+    copy->cells = memcpy(command_alloc(queue, cells_size),
+                         grid->cells, cells_size);
+
+    if (grid->transforms != NULL) {
+        size_t const transforms_size = (sizeof(struct term_transform) *
+                                        grid->count);
+
+        copy->transforms = memcpy(command_alloc(queue, transforms_size),
+                                  grid->transforms, transforms_size);
+    }
+
+    return copy;
+}
+
+static
+void
+term_print_grid(struct command const * const command,
+                struct term_transform const * transform,
+                struct term_list * const list)
+{
+    struct term_grid const * const grid = command->content.grid;
+
     struct graphics_font font;
 
-    font.columns = IBM8x8_COLUMNS;
-    font.rows = IBM8x8_ROWS;
-    font.size = IBM8x8_CELL_SIZE;
+    graphics_get_font(terminal.graphics, command->font, &font);
+
+    struct viewport viewport;
+
+    graphics_get_viewport(terminal.graphics, &viewport);
+
+    // each cell is printed as if it was a string of a single glyph; i.e.
+    // a glyph at the origin of a layout holding a single line
+    int32_t line_width;
+
+    struct layout layout;
+
+    layout.line_widths = &line_width;
+    layout.line_count = 1;
+
+    struct term_state_print state;
+
+    state.layout = &layout;
+    state.list = list;
+    state.font = command->font;
+    state.bounds = TERM_BOUNDS_NONE;
+    state.display = viewport.resolution;
+    state.origin.z = command_index_to_z(command->index);
+
+    term_set_print_transform(&state, transform, font);
+
+    for (size_t i = 0; i < grid->count; i++) {
+        struct term_cell const cell = grid->cells[i];
+
+        if (cell.code == '\n') {
+            // don't print stuff we don't need to
+            continue;
+        }
+
+        uint8_t const index = (cell.code & TERM_CELL_INDEXED) ?
+            (uint8_t)(cell.code & 0xFF) :
+            codepage_index(terminal.codepage, cell.code);
+
+        if (index == 0 || index == CODEPAGE_SPACE) {
+            // don't print stuff we don't need to
+            continue;
+        }
+
+        if (grid->transforms != NULL) {
+            transform = &grid->transforms[i];
+
+            term_set_print_transform(&state, transform, font);
+        }
+
+        size_t const column = i % grid->columns;
+        size_t const row = i / grid->columns;
+
+        state.origin.x = (float)command->origin.x +
+            (float)column * (float)grid->pitch.width;
+        state.origin.y = (float)command->origin.y +
+            (float)row * (float)grid->pitch.height;
+
+        state.tint = (struct graphics_color) {
+            .r = cell.color.r,
+            .g = cell.color.g,
+            .b = cell.color.b,
+            .a = cell.color.a
+        };
+
+        line_width = PIXEL(state.width);
+
+        layout.size.width = line_width;
+        layout.size.height = PIXEL(state.height);
+
+        term_print_glyph(&state, (struct layout_glyph) {
+            .x = 0,
+            .y = 0,
+            .line = 0,
+            .index = index
+        });
+    }
+}
+
+static
+void
+term_set_print_transform(struct term_state_print * const state,
+                         struct term_transform const * const transform,
+                         struct graphics_font const font)
+{
+    state->width = (float)font.size * transform->scale.horizontal;
+    state->height = (float)font.size * transform->scale.vertical;
+
+    struct term_rotation const rotate = transform->rotate;
+
+    state->rotation = rotate.rotation;
+    state->anchor = rotate.anchor;
+
+    state->radians = 0;
+
+    if (rotate.angle != 0 && rotate.angle != 360) {
+        state->radians = (float)((rotate.angle * M_PI) / 180.0f);
+    }
+
+    state->scale = transform->scale;
+}
+
+static
+void
+term_list_add(struct term_list * const list,
+              struct graphics_glyph const glyph)
+{
+    if (list->glyph_count == list->glyph_capacity) {
+        list->glyph_capacity *= 2;
+        list->glyphs = realloc(list->glyphs,
+                               sizeof(struct graphics_glyph) *
+                               list->glyph_capacity);
+    }
 
-    graphics_set_font(terminal.graphics, image, font);
+    list->glyphs[list->glyph_count] = glyph;
+    list->glyph_count += 1;
 }
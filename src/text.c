@@ -0,0 +1,475 @@
+#include <termlike/text.h> // term_text, term_*_text, term_text_*
+#include <termlike/bounds.h> // term_bounds, term_wrap
+
+#include <stdlib.h> // malloc, realloc, free
+#include <stdint.h> // uint32_t, int32_t
+#include <stddef.h> // size_t, NULL
+#include <stdbool.h> // bool
+
+#include <string.h> // memmove, strlen
+
+#include "internal.h" // term_layout_text
+#include "buffer.h" // buffer, buffer_*
+#include "layout.h" // layout, layout_*
+#include "decode.h" // decode_utf8
+
+#ifdef DEBUG
+ #include <assert.h> // assert
+#endif
+
+/**
+ * The number of characters a text can initially hold.
+ */
+#define TEXT_INITIAL_CAPACITY 256
+/**
+ * The number of paragraphs a text can initially hold.
+ */
+#define TEXT_INITIAL_PARAGRAPH_CAPACITY 8
+
+/**
+ * Represents a run of characters between linebreaks.
+ */
+struct text_paragraph {
+    /**
+     * The glyph indices of the characters, as wrapped into lines.
+     */
+    struct buffer * buffer;
+    /**
+     * The number of characters (not counting the linebreak that ends it).
+     */
+    size_t length;
+    /**
+     * Determine whether the paragraph was edited since it was last wrapped.
+     */
+    bool is_dirty;
+};
+
+struct term_text {
+    /**
+     * The codepoints of all characters, with a gap at the point of editing.
+     *
+     * Characters are moved across the gap whenever the point of editing moves,
+     * so that repeated edits at (or near) the same point are cheap.
+     */
+    uint32_t * codepoints;
+    size_t capacity;
+    size_t gap_start;
+    size_t gap_end;
+    struct text_paragraph * paragraphs;
+    size_t paragraph_count;
+    size_t paragraph_capacity;
+    struct layout layout;
+    /**
+     * The values that the paragraphs were last wrapped, and the layout last
+     * laid out, with.
+     */
+    struct codepage const * codepage;
+    struct term_bounds bounds;
+    size_t limit;
+    float width, height;
+    /**
+     * Determine whether the layout reflects the current contents.
+     */
+    bool is_laid_out;
+};
+
+static size_t text_length(struct term_text const *);
+static void text_move_gap(struct term_text *, size_t position);
+static void text_reserve(struct term_text *, size_t count);
+static size_t text_find_paragraph(struct term_text const *,
+                                  size_t position,
+                                  size_t * offset);
+static void text_insert_paragraphs(struct term_text *,
+                                   size_t index,
+                                   size_t count);
+static void text_remove_paragraphs(struct term_text *,
+                                   size_t index,
+                                   size_t count);
+static void text_wrap_paragraph(struct term_text *,
+                                struct text_paragraph *,
+                                size_t start);
+
+struct term_text *
+term_create_text(void)
+{
+    struct term_text * const text = malloc(sizeof(struct term_text));
+
+    text->capacity = TEXT_INITIAL_CAPACITY;
+    text->codepoints = malloc(sizeof(uint32_t) * text->capacity);
+    text->gap_start = 0;
+    text->gap_end = text->capacity;
+
+    text->paragraph_count = 0;
+    text->paragraph_capacity = TEXT_INITIAL_PARAGRAPH_CAPACITY;
+    text->paragraphs = malloc(sizeof(struct text_paragraph) *
+                              text->paragraph_capacity);
+
+    // there's always at least one paragraph, even if empty
+    text_insert_paragraphs(text, 0, 1);
+
+    layout_init(&text->layout);
+
+    text->codepage = NULL;
+    text->is_laid_out = false;
+
+    return text;
+}
+
+void
+term_release_text(struct term_text * const text)
+{
+    text_remove_paragraphs(text, 0, text->paragraph_count);
+
+    layout_release(&text->layout);
+
+    free(text->paragraphs);
+    free(text->codepoints);
+    free(text);
+}
+
+void
+term_text_insert(struct term_text * const text,
+                 size_t position,
+                 char const * const characters)
+{
+#ifdef DEBUG
+    assert(characters != NULL /* can't insert nothing */);
+#endif
+    size_t const size = strlen(characters);
+
+    if (size == 0) {
+        return;
+    }
+
+    size_t const length = text_length(text);
+
+    if (position > length) {
+        position = length;
+    }
+
+    // a string never decodes into more characters than it has bytes
+    text_reserve(text, size);
+    text_move_gap(text, position);
+
+    int32_t error = 0;
+
+    // decode directly into the gap
+    uint32_t * const inserted = &text->codepoints[text->gap_start];
+
+    size_t const count = decode_utf8(characters, size, inserted, 0, &error);
+#ifdef DEBUG
+    assert(error == 0 /* see utf8.h for error description */);
+#endif
+    text->gap_start += count;
+
+    size_t offset;
+    size_t const index = text_find_paragraph(text, position, &offset);
+
+    // whatever followed the point of insertion ends up in the last paragraph
+    size_t const remainder = text->paragraphs[index].length - offset;
+
+    text->paragraphs[index].length = offset;
+    text->paragraphs[index].is_dirty = true;
+
+    size_t current = index;
+
+    for (size_t i = 0; i < count; i++) {
+        if (inserted[i] == '\n') {
+            // a linebreak splits the paragraph
+            text_insert_paragraphs(text, current + 1, 1);
+
+            current += 1;
+        } else {
+            text->paragraphs[current].length += 1;
+        }
+    }
+
+    text->paragraphs[current].length += remainder;
+
+    text->is_laid_out = false;
+}
+
+void
+term_text_erase(struct term_text * const text,
+                size_t const position,
+                size_t count)
+{
+    size_t const length = text_length(text);
+
+    if (position >= length || count == 0) {
+        return;
+    }
+
+    if (count > length - position) {
+        count = length - position;
+    }
+
+    text_move_gap(text, position);
+
+    size_t offset;
+    size_t const index = text_find_paragraph(text, position, &offset);
+
+    // count removed linebreaks; each one merges two paragraphs
+    size_t merged = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (text->codepoints[text->gap_end + i] == '\n') {
+            merged += 1;
+        }
+    }
+
+    // widen the gap over the erased characters
+    text->gap_end += count;
+
+    // the first paragraph keeps what preceded the point of erasure, and takes
+    // on whatever remains of the last paragraph
+    size_t removed = count;
+    size_t remainder = text->paragraphs[index].length - offset;
+
+    for (size_t i = 0; i < merged; i++) {
+        // skip past the rest of the previous paragraph, and its linebreak
+        removed -= remainder + 1;
+        remainder = text->paragraphs[index + 1 + i].length;
+    }
+
+    text->paragraphs[index].length = offset + (remainder - removed);
+    text->paragraphs[index].is_dirty = true;
+
+    text_remove_paragraphs(text, index + 1, merged);
+
+    text->is_laid_out = false;
+}
+
+size_t
+term_text_length(struct term_text const * const text)
+{
+    return text_length(text);
+}
+
+struct layout const *
+term_layout_text(struct term_text * const text,
+                 struct codepage const * const codepage,
+                 struct term_bounds const bounds,
+                 size_t const limit,
+                 float const width,
+                 float const height)
+{
+    bool const is_wrapped_differently = (
+        text->codepage != codepage ||
+        text->limit != limit ||
+        text->bounds.wrap != bounds.wrap);
+
+    // note that alignment is applied when printing, and so does not matter
+    if (text->is_laid_out &&
+        !is_wrapped_differently &&
+        text->width == width &&
+        text->height == height &&
+        text->bounds.size.height == bounds.size.height) {
+        return &text->layout;
+    }
+
+    text->codepage = codepage;
+    text->bounds = bounds;
+    text->limit = limit;
+    text->width = width;
+    text->height = height;
+
+    layout_clear(&text->layout);
+
+    size_t start = 0;
+
+    for (size_t i = 0; i < text->paragraph_count; i++) {
+        struct text_paragraph * const paragraph = &text->paragraphs[i];
+
+        if (paragraph->is_dirty || is_wrapped_differently) {
+            text_wrap_paragraph(text, paragraph, start);
+        }
+
+        // lay out each paragraph below the previous one
+        layout_buffer(&text->layout, paragraph->buffer, bounds, width, height);
+
+        // skip past the paragraph, and its linebreak
+        start += paragraph->length + 1;
+    }
+
+    text->is_laid_out = true;
+
+    return &text->layout;
+}
+
+static
+size_t
+text_length(struct term_text const * const text)
+{
+    return text->capacity - (text->gap_end - text->gap_start);
+}
+
+static
+void
+text_move_gap(struct term_text * const text, size_t const position)
+{
+    uint32_t * const codepoints = text->codepoints;
+
+    if (position < text->gap_start) {
+        // move characters from before the gap to after it
+        size_t const count = text->gap_start - position;
+
+        memmove(&codepoints[text->gap_end - count],
+                &codepoints[position],
+                sizeof(uint32_t) * count);
+
+        text->gap_start -= count;
+        text->gap_end -= count;
+    } else if (position > text->gap_start) {
+        // move characters from after the gap to before it
+        size_t const count = position - text->gap_start;
+
+        memmove(&codepoints[text->gap_start],
+                &codepoints[text->gap_end],
+                sizeof(uint32_t) * count);
+
+        text->gap_start += count;
+        text->gap_end += count;
+    }
+}
+
+static
+void
+text_reserve(struct term_text * const text, size_t const count)
+{
+    size_t const gap = text->gap_end - text->gap_start;
+
+    if (gap >= count) {
+        return;
+    }
+
+    size_t const length = text_length(text);
+    size_t const trailing = text->capacity - text->gap_end;
+
+    size_t expanded_capacity = text->capacity * 2;
+
+    while (expanded_capacity - length < count) {
+        expanded_capacity *= 2;
+    }
+
+    text->codepoints = realloc(text->codepoints,
+                               sizeof(uint32_t) * expanded_capacity);
+
+    // keep characters following the gap at the very end
+    memmove(&text->codepoints[expanded_capacity - trailing],
+            &text->codepoints[text->gap_end],
+            sizeof(uint32_t) * trailing);
+
+    text->gap_end = expanded_capacity - trailing;
+    text->capacity = expanded_capacity;
+}
+
+static
+size_t
+text_find_paragraph(struct term_text const * const text,
+                    size_t const position,
+                    size_t * const offset)
+{
+    size_t start = 0;
+
+    for (size_t i = 0; i < text->paragraph_count; i++) {
+        size_t const length = text->paragraphs[i].length;
+
+        // a position right before a linebreak still belongs to the paragraph
+        if (position <= start + length) {
+            *offset = position - start;
+
+            return i;
+        }
+
+        start += length + 1;
+    }
+
+    // never happens; every position is within a paragraph
+    *offset = text->paragraphs[text->paragraph_count - 1].length;
+
+    return text->paragraph_count - 1;
+}
+
+static
+void
+text_insert_paragraphs(struct term_text * const text,
+                       size_t const index,
+                       size_t const count)
+{
+    size_t const required = text->paragraph_count + count;
+
+    if (required > text->paragraph_capacity) {
+        while (text->paragraph_capacity < required) {
+            text->paragraph_capacity *= 2;
+        }
+
+        text->paragraphs = realloc(text->paragraphs,
+                                   sizeof(struct text_paragraph) *
+                                   text->paragraph_capacity);
+    }
+
+    memmove(&text->paragraphs[index + count],
+            &text->paragraphs[index],
+            sizeof(struct text_paragraph) * (text->paragraph_count - index));
+
+    for (size_t i = index; i < index + count; i++) {
+        text->paragraphs[i] = (struct text_paragraph) {
+            .buffer = buffer_init(),
+            .length = 0,
+            .is_dirty = true
+        };
+    }
+
+    text->paragraph_count = required;
+}
+
+static
+void
+text_remove_paragraphs(struct term_text * const text,
+                       size_t const index,
+                       size_t const count)
+{
+    for (size_t i = index; i < index + count; i++) {
+        buffer_release(text->paragraphs[i].buffer);
+    }
+
+    memmove(&text->paragraphs[index],
+            &text->paragraphs[index + count],
+            sizeof(struct text_paragraph) *
+            (text->paragraph_count - index - count));
+
+    text->paragraph_count -= count;
+}
+
+static
+void
+text_wrap_paragraph(struct term_text * const text,
+                    struct text_paragraph * const paragraph,
+                    size_t const start)
+{
+    buffer_clear(paragraph->buffer);
+
+    size_t const end = start + paragraph->length;
+
+    // the paragraph may straddle the gap; if so, append the characters on
+    // either side of it separately
+    if (start < text->gap_start) {
+        size_t const before = (end < text->gap_start ? end : text->gap_start);
+
+        buffer_append(paragraph->buffer, text->codepage,
+                      &text->codepoints[start], before - start);
+    }
+
+    if (end > text->gap_start) {
+        size_t const after = (start > text->gap_start ? start : text->gap_start);
+        size_t const gap = text->gap_end - text->gap_start;
+
+        buffer_append(paragraph->buffer, text->codepage,
+                      &text->codepoints[after + gap], end - after);
+    }
+
+    buffer_wrap(paragraph->buffer, text->limit, text->bounds.wrap);
+
+    paragraph->is_dirty = false;
+}